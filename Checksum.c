@@ -0,0 +1,98 @@
+#include "Checksum.h"
+#include <string.h>
+#include <pthread.h>
+
+#define CRC32C_POLYNOMIAL 0x82f63b78UL	/* the Castagnoli polynomial, with its bits reversed */
+#define CHECKSUM_MASK 0xffffffffUL
+#define TABLES 8
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CHECKSUM_INSTRUCTION
+#endif
+
+/* table[k][b] is the checksum of the byte b followed by k zero bytes, so eight bytes are
+taken at a time by looking each of them up in a different table */
+static unsigned long table[TABLES][256];
+static pthread_once_t table_once = PTHREAD_ONCE_INIT;
+#ifdef CHECKSUM_INSTRUCTION
+static int use_instruction;	/* non-zero if the processor has the crc32 instruction */
+#endif
+
+/* Fill in the tables, and find whether the processor has the crc32 instruction */
+static void create_tables(void);
+
+#ifdef CHECKSUM_INSTRUCTION
+/* Return the checksum of the data with the crc32 instruction, taking and returning
+the checksum before its final complement */
+static unsigned long instruction_checksum(unsigned long crc, const unsigned char* bytes, size_t size) __attribute__((target("sse4.2")));
+#endif
+
+/* Return the checksum of the data that follows data with the supplied checksum. */
+unsigned long update_checksum(unsigned long checksum, const void* data, size_t size)
+{
+	const unsigned char *bytes = data;
+	unsigned long crc = ~checksum & CHECKSUM_MASK;
+	pthread_once(&table_once, create_tables);
+#ifdef CHECKSUM_INSTRUCTION
+	if (use_instruction)
+	{
+		return ~instruction_checksum(crc, bytes, size) & CHECKSUM_MASK;
+	}
+#endif
+	for (; size >= TABLES; size -= TABLES, bytes += TABLES)
+	{
+		crc ^= bytes[0] | (unsigned long)bytes[1] << 8 | (unsigned long)bytes[2] << 16 | (unsigned long)bytes[3] << 24;
+		crc = table[7][crc & 0xff] ^ table[6][(crc >> 8) & 0xff] ^ table[5][(crc >> 16) & 0xff] ^ table[4][crc >> 24]
+			^ table[3][bytes[4]] ^ table[2][bytes[5]] ^ table[1][bytes[6]] ^ table[0][bytes[7]];
+	}
+	for (; size > 0; size--, bytes++)
+	{
+		crc = table[0][(crc ^ *bytes) & 0xff] ^ (crc >> 8);
+	}
+	return ~crc & CHECKSUM_MASK;
+}
+
+/* Fill in the tables, and find whether the processor has the crc32 instruction */
+static void create_tables(void)
+{
+	int b, k;
+	for (b = 0; b < 256; b++)
+	{
+		unsigned long crc = b;
+		for (k = 0; k < 8; k++)
+		{
+			crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLYNOMIAL : crc >> 1;
+		}
+		table[0][b] = crc;
+	}
+	for (b = 0; b < 256; b++)
+	{
+		for (k = 1; k < TABLES; k++)
+		{
+			table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xff];
+		}
+	}
+#ifdef CHECKSUM_INSTRUCTION
+	__builtin_cpu_init();
+	use_instruction = __builtin_cpu_supports("sse4.2");
+#endif
+}
+
+#ifdef CHECKSUM_INSTRUCTION
+/* Return the checksum of the data with the crc32 instruction, taking and returning
+the checksum before its final complement */
+static unsigned long instruction_checksum(unsigned long crc, const unsigned char* bytes, size_t size)
+{
+	for (; size >= sizeof(unsigned long); size -= sizeof(unsigned long), bytes += sizeof(unsigned long))
+	{
+		unsigned long word;
+		memcpy(&word, bytes, sizeof(unsigned long));
+		crc = __builtin_ia32_crc32di(crc, word);
+	}
+	for (; size > 0; size--, bytes++)
+	{
+		crc = __builtin_ia32_crc32qi(crc, *bytes);
+	}
+	return crc;
+}
+#endif
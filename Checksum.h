@@ -0,0 +1,19 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+/*
+The CRC-32C checksum, which save and image files use to find damaged data before any of
+it is restored. A checksum can be computed in pieces, by giving each piece the checksum of
+the ones before it. On x86-64 processors with SSE4.2 the crc32 instruction is used, and
+otherwise tables that take eight bytes at a time.
+*/
+
+#include <stddef.h> /* for the declaration of size_t */
+
+/* the checksum of no data, to start from */
+#define CHECKSUM_INITIAL 0UL
+
+/* Return the checksum of the data that follows data with the supplied checksum. */
+unsigned long update_checksum(unsigned long checksum, const void* data, size_t size);
+
+#endif
@@ -2,21 +2,47 @@
 #include "Record.h"
 #include "Ordered_container.h"
 #include "Utility.h"
+#include "Lexer.h"
+#include "Output.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include "p1_globals.h"
 
+/* the number of members of a Collection with a medium */
+struct Medium_count {
+	char medium[MEDIUM_BUFFER_SIZE];
+	int count;
+};
+
 /* a Collection contains a pointer to a C-string name and a container
-that holds pointers to Records - the members. */
+that holds pointers to Records - the members - and the statistics of the members,
+with the counts of the media in medium order, for only the media of any member. */
 struct Collection {
 	char* name;
 	struct Ordered_container* members; 
+	int rated_count;
+	int rating_sum;
+	struct Medium_count* media;
+	int media_count;
 };
 
 /* Used to save all members of the collection */
 void save_one_record(void* record, void* current_file);
 
+/* Add a member known not to be present, linking it to the Collection and counting it in the statistics */
+static void insert_member(struct Collection* collection_ptr, struct Record* record_ptr);
+
+/* Remove the link from a member to the Collection, which is being destroyed */
+static void unlink_member(void* record_ptr, void* collection_ptr);
+
+/* Change the number of members with the medium of the record by change */
+static void count_member_medium(struct Collection* collection_ptr, const struct Record* record_ptr, int change);
+
+/* Read a Collection's name and create it, and read the number of its members;
+returns NULL if invalid data discovered in file */
+struct Collection* load_Collection_header(struct Lexer* input, int* elements);
+
 /* Create a Collection object.
 This is the only function that allocates memory for a Collection
 and the contained data. */
@@ -26,7 +52,11 @@ struct Collection* create_Collection(const char* name)
 	int name_len = strlen(name) + 1;
 	g_string_memory += name_len;
 	collection->name = strcpy(malloc(name_len), name);
-	collection->members = OC_create_container(record_compare_title);
+	collection->members = OC_create_container_backend(record_compare_title, OC_ARRAY_BACKEND);
+	collection->rated_count = 0;
+	collection->rating_sum = 0;
+	collection->media = NULL;
+	collection->media_count = 0;
 	return collection;
 }
 
@@ -38,7 +68,9 @@ void destroy_Collection(struct Collection* collection_ptr)
 {
 	g_string_memory -= strlen(collection_ptr->name) + 1;
 	free(collection_ptr->name);
+	OC_apply_arg(collection_ptr->members, unlink_member, collection_ptr);
 	OC_destroy_container(collection_ptr->members);
+	free(collection_ptr->media);
 	free(collection_ptr);
 }
 
@@ -54,12 +86,24 @@ int Collection_empty(const struct Collection* collection_ptr)
 	return OC_empty(collection_ptr->members);
 }
 
+/* Return the number of members. */
+int get_Collection_size(const struct Collection* collection_ptr)
+{
+	return OC_get_size(collection_ptr->members);
+}
+
+/* Apply the function to each member in title order, with the supplied argument. */
+void apply_Collection_members(const struct Collection* collection_ptr, Collection_member_fp_t func, void* arg_ptr)
+{
+	OC_apply_arg(collection_ptr->members, func, arg_ptr);
+}
+
 /* Add a member; return non-zero and do nothing if already present. */
-int add_Collection_member(struct Collection* collection_ptr, const struct Record* record_ptr)
+int add_Collection_member(struct Collection* collection_ptr, struct Record* record_ptr)
 {
 	if (!is_Collection_member_present(collection_ptr, record_ptr))
 	{
-		OC_insert(collection_ptr->members, record_ptr);
+		insert_member(collection_ptr, record_ptr);
 		return 0;
 	}
 	return 1;
@@ -72,62 +116,111 @@ int is_Collection_member_present(const struct Collection* collection_ptr, const
 }
 
 /* Remove a member; return non-zero if not present, zero if was present. */
-int remove_Collection_member(struct Collection* collection_ptr, const struct Record* record_ptr)
+int remove_Collection_member(struct Collection* collection_ptr, struct Record* record_ptr)
 {
 	void *item = OC_find_item(collection_ptr->members, record_ptr);
 	if (item)
 	{
 		OC_delete_item(collection_ptr->members, item);
+		remove_Record_membership(record_ptr, collection_ptr);
+		remove_Collection_member_rating(collection_ptr, record_ptr);
+		count_member_medium(collection_ptr, record_ptr, -1);
 		return 0;
 	}
 	return 1;
 }
 
+/* Return the number of rated members, and set rating_sum_ptr to the sum of their ratings. */
+int get_Collection_rated(const struct Collection* collection_ptr, int* rating_sum_ptr)
+{
+	*rating_sum_ptr = collection_ptr->rating_sum;
+	return collection_ptr->rated_count;
+}
+
+/* Take a member's rating out of the statistics, before the rating is changed. */
+void remove_Collection_member_rating(struct Collection* collection_ptr, const struct Record* record_ptr)
+{
+	int rating = get_Record_rating(record_ptr);
+	if (rating != 0)
+	{
+		collection_ptr->rated_count--;
+		collection_ptr->rating_sum -= rating;
+	}
+}
+
+/* Put a member's rating back into the statistics, after the rating is changed. */
+void add_Collection_member_rating(struct Collection* collection_ptr, const struct Record* record_ptr)
+{
+	int rating = get_Record_rating(record_ptr);
+	if (rating != 0)
+	{
+		collection_ptr->rated_count++;
+		collection_ptr->rating_sum += rating;
+	}
+}
+
+/* Take every member's rating out of the statistics, as if no member were rated. */
+void clear_Collection_ratings(struct Collection* collection_ptr)
+{
+	collection_ptr->rated_count = 0;
+	collection_ptr->rating_sum = 0;
+}
+
+/* Print the statistics of a Collection: the numbers of members and rated members,
+the average rating, and the number of members with each medium. */
+void print_Collection_statistics(const struct Collection* collection_ptr)
+{
+	int i;
+	output_format("Collection %s has %d members, %d rated", collection_ptr->name,
+		OC_get_size(collection_ptr->members), collection_ptr->rated_count);
+	if (collection_ptr->rated_count > 0)
+	{
+		output_format(", average rating %.2f", (double)collection_ptr->rating_sum / collection_ptr->rated_count);
+	}
+	output_char('\n');
+	for (i = 0; i < collection_ptr->media_count; i++)
+	{
+		output_format("%s: %d\n", collection_ptr->media[i].medium, collection_ptr->media[i].count);
+	}
+}
+
 /* Print the data in a Collection. */
 void print_Collection(const struct Collection* collection_ptr)
 {
-	printf("Collection %s contains:", collection_ptr->name);
+	output_format("Collection %s contains:", collection_ptr->name);
 	if (!Collection_empty(collection_ptr))
 	{
-		printf("\n");
+		output_char('\n');
 		OC_apply(collection_ptr->members, record_print);
 	}
 	else
 	{
-		printf(" None\n");
+		output_string(" None\n");
 	}
 }
 
-/* Write the data in a Collection to a file. */
+/* Write the data in a Collection to a file, giving the members by ID number. */
 void save_Collection(const struct Collection* collection_ptr, FILE* outfile)
 {
 	fprintf(outfile, "%s %d\n", collection_ptr->name, OC_get_size(collection_ptr->members));
 	OC_apply_arg(collection_ptr->members, save_one_record, outfile);
 }
 
-/* Read a Collection's data from a file stream, create the data object and
+/* Read a Collection's data from a file stream's Lexer, create the data object and
 return a pointer to it, NULL if invalid data discovered in file.
 No check made for whether the Collection already exists or not. */
-struct Collection* load_Collection(FILE* input_file, const struct Ordered_container* records)
+struct Collection* load_Collection(struct Lexer* input, const struct Ordered_container* records)
 {
-	struct Collection *collection;
-	char collection_name[NAME_BUFFER_SIZE];
-	int elements = 0;
-	if (fscanf(input_file, NAME_SCAN_BUFFER, collection_name) != 1)
-	{
-		/* error reading name */
-		return NULL;
-	}
-	if (fscanf(input_file, "%d\n", &elements) != 1)
+	int elements;
+	struct Collection *collection = load_Collection_header(input, &elements);
+	if (!collection)
 	{
-		/* error reading size */
 		return NULL;
 	}
-	collection = create_Collection(collection_name);
 	for (; elements > 0; elements--)
 	{
 		char title_buffer[TITLE_BUFFER_SIZE];
-		char *title = read_title(title_buffer, input_file);
+		char *title = read_title(title_buffer, input);
 		void *item;
 		if (title == NULL)
 		{
@@ -142,7 +235,40 @@ struct Collection* load_Collection(FILE* input_file, const struct Ordered_contai
 			destroy_Collection(collection);
 			return NULL;
 		}
-		OC_insert(collection->members, OC_get_data_ptr(item));
+		insert_member(collection, OC_get_data_ptr(item));
+	}
+	return collection;
+}
+
+/* Read a Collection's data like load_Collection, except that the members are given by ID number,
+as written by save_Collection, and are found in records, which must be ordered by ID number. */
+struct Collection* load_Collection_by_ID(struct Lexer* input, const struct Ordered_container* records)
+{
+	int elements;
+	struct Collection *collection = load_Collection_header(input, &elements);
+	if (!collection)
+	{
+		return NULL;
+	}
+	for (; elements > 0; elements--)
+	{
+		int id;
+		void *item;
+		if (!lex_int(input, &id))
+		{
+			/* error reading record ID */
+			destroy_Collection(collection);
+			return NULL;
+		}
+		item = OC_find_item_arg(records, &id, record_id_compare);
+		if (item == NULL)
+		{
+			/* ID not found in library */
+			destroy_Collection(collection);
+			return NULL;
+		}
+		/* members are saved in title order, so each one goes at the end */
+		insert_member(collection, OC_get_data_ptr(item));
 	}
 	return collection;
 }
@@ -150,5 +276,68 @@ struct Collection* load_Collection(FILE* input_file, const struct Ordered_contai
 /* Used to save all members of the collection */
 void save_one_record(void* record, void* current_file)
 {
-	fprintf((FILE*)current_file, "%s\n", get_Record_title((struct Record *)record));
-}
\ No newline at end of file
+	fprintf((FILE*)current_file, "%d\n", get_Record_ID((struct Record *)record));
+}
+
+/* Read a Collection's name and create it, and read the number of its members;
+returns NULL if invalid data discovered in file */
+struct Collection* load_Collection_header(struct Lexer* input, int* elements)
+{
+	char collection_name[NAME_BUFFER_SIZE];
+	if (!lex_word(input, collection_name, NAME_BUFFER_SIZE))
+	{
+		/* error reading name */
+		return NULL;
+	}
+	if (!lex_int(input, elements))
+	{
+		/* error reading size */
+		return NULL;
+	}
+	lex_skip_whitespace(input);
+	return create_Collection(collection_name);
+}
+
+/* Add a member known not to be present, linking it to the Collection and counting it in the statistics */
+static void insert_member(struct Collection* collection_ptr, struct Record* record_ptr)
+{
+	OC_insert(collection_ptr->members, record_ptr);
+	add_Record_membership(record_ptr, collection_ptr);
+	add_Collection_member_rating(collection_ptr, record_ptr);
+	count_member_medium(collection_ptr, record_ptr, 1);
+}
+
+/* Remove the link from a member to the Collection, which is being destroyed */
+static void unlink_member(void* record_ptr, void* collection_ptr)
+{
+	remove_Record_membership(record_ptr, collection_ptr);
+}
+
+/* Change the number of members with the medium of the record by change */
+static void count_member_medium(struct Collection* collection_ptr, const struct Record* record_ptr, int change)
+{
+	const char *medium = get_Record_medium(record_ptr);
+	int i;
+	for (i = 0; i < collection_ptr->media_count; i++)
+	{
+		if (strcmp(collection_ptr->media[i].medium, medium) >= 0)
+		{
+			break;
+		}
+	}
+	if (i == collection_ptr->media_count || strcmp(collection_ptr->media[i].medium, medium) != 0)
+	{
+		/* the first member with the medium; there are few media, so the array is kept exactly full */
+		collection_ptr->media = realloc(collection_ptr->media, (collection_ptr->media_count + 1) * sizeof(struct Medium_count));
+		memmove(&collection_ptr->media[i + 1], &collection_ptr->media[i], (collection_ptr->media_count - i) * sizeof(struct Medium_count));
+		collection_ptr->media_count++;
+		strcpy(collection_ptr->media[i].medium, medium);
+		collection_ptr->media[i].count = 0;
+	}
+	collection_ptr->media[i].count += change;
+	if (collection_ptr->media[i].count == 0)
+	{
+		collection_ptr->media_count--;
+		memmove(&collection_ptr->media[i], &collection_ptr->media[i + 1], (collection_ptr->media_count - i) * sizeof(struct Medium_count));
+	}
+}
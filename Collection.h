@@ -5,6 +5,12 @@
 Collections are an opaque type containing a name stored as a pointer to a C-string
 in allocated member, and a container of members, represented as pointers to
 Records.
+
+A Collection also keeps statistics of its members, updated as each one is added or removed:
+the number that are rated, the sum of their ratings, and the number with each medium, so
+they can be reported without going through the members. A member's rating is taken out of
+them before the rating changes and put back afterwards; the Collections to tell are found
+through the Record, which is linked to each Collection it is a member of.
 */
 
 #include <stdio.h> /* for the declaration of FILE */
@@ -13,6 +19,7 @@ Records.
 struct Collection;
 struct Record;
 struct Ordered_container;
+struct Lexer;
 
 /* Create a Collection object.
 This is the only function that allocates memory for a Collection
@@ -31,24 +38,54 @@ const char* get_Collection_name(const struct Collection* collection_ptr);
 /* return non-zero if there are no members, 0 if there are members */
 int Collection_empty(const struct Collection* collection_ptr);
 
+/* type of a function applied to each member, with the supplied argument */
+typedef void (*Collection_member_fp_t) (void* record_ptr, void* arg_ptr);
+
+/* Return the number of members. */
+int get_Collection_size(const struct Collection* collection_ptr);
+
+/* Apply the function to each member in title order, with the supplied argument. */
+void apply_Collection_members(const struct Collection* collection_ptr, Collection_member_fp_t func, void* arg_ptr);
+
 /* Add a member; return non-zero and do nothing if already present. */
-int add_Collection_member(struct Collection* collection_ptr, const struct Record* record_ptr);
+int add_Collection_member(struct Collection* collection_ptr, struct Record* record_ptr);
 
 /* Return non-zero if the record is a member, zero if not. */
 int is_Collection_member_present(const struct Collection* collection_ptr, const struct Record* record_ptr);
 
 /* Remove a member; return non-zero if not present, zero if was present. */
-int remove_Collection_member(struct Collection* collection_ptr, const struct Record* record_ptr);
+int remove_Collection_member(struct Collection* collection_ptr, struct Record* record_ptr);
+
+/* Return the number of rated members, and set rating_sum_ptr to the sum of their ratings. */
+int get_Collection_rated(const struct Collection* collection_ptr, int* rating_sum_ptr);
+
+/* Take a member's rating out of the statistics, before the rating is changed. */
+void remove_Collection_member_rating(struct Collection* collection_ptr, const struct Record* record_ptr);
+
+/* Put a member's rating back into the statistics, after the rating is changed. */
+void add_Collection_member_rating(struct Collection* collection_ptr, const struct Record* record_ptr);
+
+/* Take every member's rating out of the statistics, as if no member were rated. */
+void clear_Collection_ratings(struct Collection* collection_ptr);
+
+/* Print the statistics of a Collection: the numbers of members and rated members,
+the average rating, and the number of members with each medium. */
+void print_Collection_statistics(const struct Collection* collection_ptr);
 
 /* Print the data in a Collection. */
 void print_Collection(const struct Collection* collection_ptr);
 
-/* Write the data in a Collection to a file. */
+/* Write the data in a Collection to a file, giving the members by ID number. */
 void save_Collection(const struct Collection* collection_ptr, FILE* outfile);
 
-/* Read a Collection's data from a file stream, create the data object and 
+/* Read a Collection's data from a file stream's Lexer, create the data object and 
 return a pointer to it, NULL if invalid data discovered in file. 
+The members are given by title, as in version 1 save files, and are found in records, which must be ordered by title.
 No check made for whether the Collection already exists or not. */
-struct Collection* load_Collection(FILE* input_file, const struct Ordered_container* records);
+struct Collection* load_Collection(struct Lexer* input, const struct Ordered_container* records);
+
+/* Read a Collection's data like load_Collection, except that the members are given by ID number,
+as written by save_Collection, and are found in records, which must be ordered by ID number. */
+struct Collection* load_Collection_by_ID(struct Lexer* input, const struct Ordered_container* records);
 
 #endif
@@ -0,0 +1,478 @@
+#define _POSIX_C_SOURCE 200112L
+#include "Image.h"
+#include "Library.h"
+#include "Collection.h"
+#include "Record.h"
+#include "Ordered_container.h"
+#include "Utility.h"
+#include "Checksum.h"
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#define IMAGE_MAGIC "p1image"
+#define IMAGE_HEADERS 2
+#define IMAGE_ALIGNMENT 4096	/* images start at a multiple of this, after the headers */
+
+/* a header gives where the image of a save is in the file, how many entries of each kind it has,
+and its checksum, with a checksum of these so that a header that was only partly written is not used */
+struct Image_header {
+	char magic[sizeof(IMAGE_MAGIC)];
+	unsigned long generation;	/* one more than that of the image before it */
+	long data_offset;
+	long data_size;
+	int records;
+	int collections;
+	int members;
+	unsigned long data_check;	/* the checksum of the image */
+	unsigned long check;		/* the checksum of the members before it */
+};
+
+/* a Record in an image; its C-strings are given by their offsets in the string area */
+struct Image_record {
+	int ID;
+	int rating;
+	long title;
+	long medium;
+};
+
+/* a Collection in an image; the ID numbers of its members follow those of the Collection before it */
+struct Image_collection {
+	long name;
+	int members;
+};
+
+/* the arrays and the string area of an image, with the number of entries of each kind
+and of bytes of C-strings in them, or written to them so far */
+struct Image_data {
+	struct Image_record* records;
+	struct Image_collection* collections;
+	int* member_IDs;
+	char* strings;
+	int record_count;
+	int collection_count;
+	int member_count;
+	long strings_size;
+};
+
+/* an Image contains the descriptor of the open file and its mapping, which is NULL if the file is empty */
+struct Image {
+	int fd;
+	char* file;
+	long file_size;
+};
+
+/* an ID number of a Record in an image with its position among the Records, to find members by */
+struct Image_ID {
+	int ID;
+	int position;
+};
+
+/* Return the checksum of the members of the header before its check */
+static unsigned long header_checksum(const struct Image_header* header_ptr);
+
+/* Find the current header of a file of file_size bytes, which starts with the headers;
+returns zero if neither header is valid. */
+static int current_header(const struct Image_header* headers, long file_size, struct Image_header* header_ptr);
+
+/* Return the size of the arrays of an image with the numbers of entries in the header */
+static long arrays_size(const struct Image_header* header_ptr);
+
+/* Set the pointers to the arrays and the string area of the image that starts at data */
+static void set_image_data(struct Image_data* data_ptr, char* data, const struct Image_header* header_ptr);
+
+/* Flush the bytes of the shared mapping of the file from offset to the end of size bytes to the file */
+static int flush_mapping(char* file, long offset, long size);
+
+/* Add the entries and C-strings of a Record to the counts of an image */
+static void count_record(void* record_ptr, void* data_ptr);
+
+/* Add the entries and C-strings of a Collection to the counts of an image */
+static void count_collection(void* collection_ptr, void* data_ptr);
+
+/* Write a Record to the next entry of an image */
+static void write_record(void* record_ptr, void* data_ptr);
+
+/* Write a Collection and the ID numbers of its members to the next entries of an image */
+static void write_collection(void* collection_ptr, void* data_ptr);
+
+/* Write the ID number of a member to the next entry of an image */
+static void write_member(void* record_ptr, void* data_ptr);
+
+/* Copy a C-string to the end of the string area of an image, and return its offset there */
+static long write_string(struct Image_data* data_ptr, const char* string);
+
+/* Return the C-string at the offset in the string area of an image, or NULL if it is
+not there, is empty, or does not end in fewer than buffer_size bytes */
+static const char* image_string(const struct Image_data* data_ptr, long offset, int buffer_size);
+
+/* Compare the ID numbers of two Records in an image */
+static int compare_image_IDs(const void* ID_ptr1, const void* ID_ptr2);
+
+/* Write the Records in the title ordering and the Collections in the catalog to the named image
+file, which is created if it does not exist. Returns non-zero if the file could not be written,
+in which case its current image is unchanged. */
+int save_Image(const char* filename, const struct Ordered_container* library_title, const struct Ordered_container* catalog)
+{
+	struct Image_header headers[IMAGE_HEADERS];
+	struct Image_header current, header;
+	struct Image_data data;
+	struct stat file_status;
+	long file_size, end;
+	char *file;
+	int has_current, failed;
+	int fd = open(filename, O_RDWR | O_CREAT, 0666);
+	if (fd < 0)
+	{
+		return 1;
+	}
+	memset(headers, 0, sizeof(headers));
+	if (fstat(fd, &file_status) != 0 || read(fd, headers, sizeof(headers)) < 0)
+	{
+		close(fd);
+		return 1;
+	}
+	file_size = file_status.st_size;
+	has_current = current_header(headers, file_size, &current);
+	memset(&data, 0, sizeof(data));
+	OC_apply_arg(library_title, count_record, &data);
+	OC_apply_arg(catalog, count_collection, &data);
+	/* the padding is in the checksum as well, so it must not be left undefined */
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+	header.generation = has_current ? current.generation + 1 : 1;
+	header.records = data.record_count;
+	header.collections = data.collection_count;
+	header.members = data.member_count;
+	header.data_size = arrays_size(&header) + data.strings_size;
+	/* the new image goes before the current one if it fits there, and otherwise after it */
+	header.data_offset = IMAGE_ALIGNMENT;
+	if (has_current && current.data_offset - IMAGE_ALIGNMENT < header.data_size)
+	{
+		header.data_offset = (current.data_offset + current.data_size + IMAGE_ALIGNMENT - 1) / IMAGE_ALIGNMENT * IMAGE_ALIGNMENT;
+	}
+	end = header.data_offset + header.data_size;
+	if (end > file_size && ftruncate(fd, end) != 0)
+	{
+		close(fd);
+		return 1;
+	}
+	file = mmap(NULL, end, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (file == MAP_FAILED)
+	{
+		close(fd);
+		return 1;
+	}
+	set_image_data(&data, file + header.data_offset, &header);
+	OC_apply_arg(library_title, write_record, &data);
+	OC_apply_arg(catalog, write_collection, &data);
+	header.data_check = update_checksum(CHECKSUM_INITIAL, file + header.data_offset, header.data_size);
+	header.check = header_checksum(&header);
+	/* the image must be in the file before the header that refers to it is */
+	failed = flush_mapping(file, header.data_offset, header.data_size);
+	if (!failed)
+	{
+		memcpy(file + header.generation % IMAGE_HEADERS * sizeof(struct Image_header), &header, sizeof(header));
+		failed = flush_mapping(file, 0, sizeof(headers));
+	}
+	munmap(file, end);
+	/* once the new header is written, nothing after the new image is needed */
+	if (!failed && end < file_size)
+	{
+		failed = ftruncate(fd, end) != 0;
+	}
+	return close(fd) != 0 || failed;
+}
+
+/* Create an Image object for the named image file, mapping it into memory.
+Returns NULL if the file could not be opened or mapped. */
+struct Image* open_Image(const char* filename)
+{
+	struct Image *image;
+	struct stat file_status;
+	char *file = NULL;
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+	{
+		return NULL;
+	}
+	if (fstat(fd, &file_status) != 0)
+	{
+		close(fd);
+		return NULL;
+	}
+	if (file_status.st_size > 0)
+	{
+		file = mmap(NULL, file_status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (file == MAP_FAILED)
+		{
+			close(fd);
+			return NULL;
+		}
+		/* the whole image is about to be read */
+		posix_madvise(file, file_status.st_size, POSIX_MADV_WILLNEED);
+	}
+	image = malloc(sizeof(struct Image));
+	image->fd = fd;
+	image->file = file;
+	image->file_size = file_status.st_size;
+	return image;
+}
+
+/* Destroy an Image object, unmapping and closing its file. */
+void close_Image(struct Image* image_ptr)
+{
+	if (image_ptr->file)
+	{
+		munmap(image_ptr->file, image_ptr->file_size);
+	}
+	close(image_ptr->fd);
+	free(image_ptr);
+}
+
+/* Return non-zero if the file has no valid image, or if its current image has invalid data:
+its checksum, every C-string and rating, the order of the Records and Collections, and the
+member ID numbers are all checked, so that nothing is cleared to restore an image that would fail. */
+int check_Image(const struct Image* image_ptr)
+{
+	struct Image_header header;
+	struct Image_data data;
+	struct Image_ID *IDs;
+	const char *previous = NULL;
+	int invalid = 0;
+	int i, j;
+	if (!image_ptr->file || !current_header((const struct Image_header*)image_ptr->file, image_ptr->file_size, &header)
+		|| update_checksum(CHECKSUM_INITIAL, image_ptr->file + header.data_offset, header.data_size) != header.data_check)
+	{
+		return 1;
+	}
+	set_image_data(&data, image_ptr->file + header.data_offset, &header);
+	data.strings_size = header.data_size - arrays_size(&header);
+	/* the Records must be in title order, as insert_Library_records requires */
+	for (i = 0; i < header.records; i++)
+	{
+		const char *title = image_string(&data, data.records[i].title, TITLE_BUFFER_SIZE);
+		if (!title || !image_string(&data, data.records[i].medium, MEDIUM_BUFFER_SIZE)
+			|| data.records[i].rating < 0 || data.records[i].rating > RATING_MAX || (previous && strcmp(previous, title) >= 0))
+		{
+			return 1;
+		}
+		previous = title;
+	}
+	/* the members are found by ID number, and each Collection's members are in title order,
+	so a member must come after the one before it in the Records as well */
+	IDs = malloc((header.records + 1) * sizeof(struct Image_ID));
+	for (i = 0; i < header.records; i++)
+	{
+		IDs[i].ID = data.records[i].ID;
+		IDs[i].position = i;
+	}
+	qsort(IDs, header.records, sizeof(struct Image_ID), compare_image_IDs);
+	for (i = 1; i < header.records && !invalid; i++)
+	{
+		invalid = IDs[i - 1].ID == IDs[i].ID;
+	}
+	previous = NULL;
+	for (i = 0; i < header.collections && !invalid; i++)
+	{
+		const struct Image_collection *entry = &data.collections[i];
+		const char *name = image_string(&data, entry->name, NAME_BUFFER_SIZE);
+		int previous_position = -1;
+		if (!name || (previous && strcmp(previous, name) >= 0) || entry->members < 0 || entry->members > header.members - data.member_count)
+		{
+			invalid = 1;
+			break;
+		}
+		previous = name;
+		for (j = 0; j < entry->members && !invalid; j++)
+		{
+			struct Image_ID key;
+			const struct Image_ID *found;
+			key.ID = data.member_IDs[data.member_count++];
+			found = bsearch(&key, IDs, header.records, sizeof(struct Image_ID), compare_image_IDs);
+			invalid = !found || found->position <= previous_position;
+			previous_position = found ? found->position : previous_position;
+		}
+	}
+	free(IDs);
+	return invalid || data.member_count != header.members;
+}
+
+/* Restore the Records and Collections of the current image into the empty Library and catalog;
+check_Image must have found the image valid. */
+void load_Image(const struct Image* image_ptr, struct Library* library_ptr, struct Ordered_container* catalog)
+{
+	struct Image_header header;
+	struct Image_data data;
+	int i, j;
+	current_header((const struct Image_header*)image_ptr->file, image_ptr->file_size, &header);
+	set_image_data(&data, image_ptr->file + header.data_offset, &header);
+	if (header.records > 0)
+	{
+		struct Record **records = malloc(header.records * sizeof(struct Record *));
+		for (i = 0; i < header.records; i++)
+		{
+			const struct Image_record *entry = &data.records[i];
+			records[i] = restore_Record(entry->ID, data.strings + entry->medium, entry->rating, data.strings + entry->title);
+		}
+		insert_Library_records(library_ptr, records, header.records);
+		free(records);
+	}
+	for (i = 0; i < header.collections; i++)
+	{
+		const struct Image_collection *entry = &data.collections[i];
+		struct Collection *collection = create_Collection(data.strings + entry->name);
+		for (j = 0; j < entry->members; j++)
+		{
+			void *item = OC_find_item_arg(get_Library_by_ID(library_ptr), &data.member_IDs[data.member_count++], record_id_compare);
+			add_Collection_member(collection, OC_get_data_ptr(item));
+		}
+		OC_insert(catalog, collection);
+	}
+}
+
+/* Compare the ID numbers of two Records in an image */
+static int compare_image_IDs(const void* ID_ptr1, const void* ID_ptr2)
+{
+	int ID1 = ((const struct Image_ID *)ID_ptr1)->ID;
+	int ID2 = ((const struct Image_ID *)ID_ptr2)->ID;
+	return ID1 < ID2 ? -1 : ID1 > ID2;
+}
+
+/* Return the checksum of the members of the header before its check */
+static unsigned long header_checksum(const struct Image_header* header_ptr)
+{
+	return update_checksum(CHECKSUM_INITIAL, header_ptr, offsetof(struct Image_header, check));
+}
+
+/* Find the current header of a file of file_size bytes, which starts with the headers;
+returns zero if neither header is valid. */
+static int current_header(const struct Image_header* headers, long file_size, struct Image_header* header_ptr)
+{
+	int found = 0;
+	int i;
+	if (file_size < IMAGE_ALIGNMENT)
+	{
+		return 0;
+	}
+	for (i = 0; i < IMAGE_HEADERS; i++)
+	{
+		const struct Image_header *header = &headers[i];
+		if (memcmp(header->magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0 || header->check != header_checksum(header)
+			|| header->data_offset < IMAGE_ALIGNMENT || header->data_offset % IMAGE_ALIGNMENT != 0
+			|| header->data_size < 0 || header->data_size > file_size - header->data_offset
+			|| header->records < 0 || header->collections < 0 || header->members < 0
+			|| arrays_size(header) > header->data_size)
+		{
+			continue;
+		}
+		if (!found || header->generation > header_ptr->generation)
+		{
+			*header_ptr = *header;
+			found = 1;
+		}
+	}
+	return found;
+}
+
+/* Return the size of the arrays of an image with the numbers of entries in the header */
+static long arrays_size(const struct Image_header* header_ptr)
+{
+	return header_ptr->records * (long)sizeof(struct Image_record) + header_ptr->collections * (long)sizeof(struct Image_collection)
+		+ header_ptr->members * (long)sizeof(int);
+}
+
+/* Set the pointers to the arrays and the string area of the image that starts at data */
+static void set_image_data(struct Image_data* data_ptr, char* data, const struct Image_header* header_ptr)
+{
+	data_ptr->records = (struct Image_record *)data;
+	data_ptr->collections = (struct Image_collection *)(data_ptr->records + header_ptr->records);
+	data_ptr->member_IDs = (int *)(data_ptr->collections + header_ptr->collections);
+	data_ptr->strings = (char *)(data_ptr->member_IDs + header_ptr->members);
+	data_ptr->record_count = 0;
+	data_ptr->collection_count = 0;
+	data_ptr->member_count = 0;
+	data_ptr->strings_size = 0;
+}
+
+/* Flush the bytes of the shared mapping of the file from offset to the end of size bytes to the file */
+static int flush_mapping(char* file, long offset, long size)
+{
+	/* msync must be given the start of a page */
+	long start = offset - offset % sysconf(_SC_PAGESIZE);
+	return msync(file + start, offset + size - start, MS_SYNC) != 0;
+}
+
+/* Add the entries and C-strings of a Record to the counts of an image */
+static void count_record(void* record_ptr, void* data_ptr)
+{
+	struct Image_data *data = data_ptr;
+	data->record_count++;
+	data->strings_size += strlen(get_Record_title(record_ptr)) + 1 + strlen(get_Record_medium(record_ptr)) + 1;
+}
+
+/* Add the entries and C-strings of a Collection to the counts of an image */
+static void count_collection(void* collection_ptr, void* data_ptr)
+{
+	struct Image_data *data = data_ptr;
+	data->collection_count++;
+	data->member_count += get_Collection_size(collection_ptr);
+	data->strings_size += strlen(get_Collection_name(collection_ptr)) + 1;
+}
+
+/* Write a Record to the next entry of an image */
+static void write_record(void* record_ptr, void* data_ptr)
+{
+	struct Image_data *data = data_ptr;
+	struct Image_record *entry = &data->records[data->record_count++];
+	entry->ID = get_Record_ID(record_ptr);
+	entry->rating = get_Record_rating(record_ptr);
+	entry->title = write_string(data, get_Record_title(record_ptr));
+	entry->medium = write_string(data, get_Record_medium(record_ptr));
+}
+
+/* Write a Collection and the ID numbers of its members to the next entries of an image */
+static void write_collection(void* collection_ptr, void* data_ptr)
+{
+	struct Image_data *data = data_ptr;
+	struct Image_collection *entry = &data->collections[data->collection_count++];
+	entry->name = write_string(data, get_Collection_name(collection_ptr));
+	entry->members = get_Collection_size(collection_ptr);
+	apply_Collection_members(collection_ptr, write_member, data);
+}
+
+/* Write the ID number of a member to the next entry of an image */
+static void write_member(void* record_ptr, void* data_ptr)
+{
+	struct Image_data *data = data_ptr;
+	data->member_IDs[data->member_count++] = get_Record_ID(record_ptr);
+}
+
+/* Copy a C-string to the end of the string area of an image, and return its offset there */
+static long write_string(struct Image_data* data_ptr, const char* string)
+{
+	long offset = data_ptr->strings_size;
+	int length = strlen(string) + 1;
+	memcpy(data_ptr->strings + offset, string, length);
+	data_ptr->strings_size += length;
+	return offset;
+}
+
+/* Return the C-string at the offset in the string area of an image, or NULL if it is
+not there, is empty, or does not end in fewer than buffer_size bytes */
+static const char* image_string(const struct Image_data* data_ptr, long offset, int buffer_size)
+{
+	const char *string;
+	long available = data_ptr->strings_size - offset;
+	if (offset < 0 || available <= 0)
+	{
+		return NULL;
+	}
+	string = data_ptr->strings + offset;
+	return *string != '\0' && memchr(string, '\0', available < buffer_size ? available : buffer_size) ? string : NULL;
+}
@@ -0,0 +1,45 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+/*
+An Image is an opaque type for a binary image file of the Library and the catalog, which is
+restored without any text being read or converted: the Records and Collections are kept in
+arrays of fixed-size entries, with their C-strings in an area after the arrays and referred
+to by their offsets in it, and the file is mapped into memory to read or write them.
+
+The file starts with two headers, and each save writes a new image to a part of the file the
+current image is not in, flushes it with msync, and only then writes and flushes the header
+that the current image's header is not in. The valid header with the larger generation number
+is current, so if a save is interrupted, the file still holds the image of the save before it.
+Each header has a checksum of itself and of its image, which is checked before restoring.
+
+An image file is only read by programs built for the same kind of machine as the one that wrote it.
+*/
+
+/* incomplete declarations */
+struct Image;
+struct Library;
+struct Ordered_container;
+
+/* Write the Records in the title ordering and the Collections in the catalog to the named image
+file, which is created if it does not exist. Returns non-zero if the file could not be written,
+in which case its current image is unchanged. */
+int save_Image(const char* filename, const struct Ordered_container* library_title, const struct Ordered_container* catalog);
+
+/* Create an Image object for the named image file, mapping it into memory.
+Returns NULL if the file could not be opened or mapped. */
+struct Image* open_Image(const char* filename);
+
+/* Destroy an Image object, unmapping and closing its file. */
+void close_Image(struct Image* image_ptr);
+
+/* Return non-zero if the file has no valid image, or if its current image has invalid data:
+its checksum, every C-string and rating, the order of the Records and Collections, and the
+member ID numbers are all checked, so that nothing is cleared to restore an image that would fail. */
+int check_Image(const struct Image* image_ptr);
+
+/* Restore the Records and Collections of the current image into the empty Library and catalog;
+check_Image must have found the image valid. */
+void load_Image(const struct Image* image_ptr, struct Library* library_ptr, struct Ordered_container* catalog);
+
+#endif
@@ -0,0 +1,105 @@
+#define _POSIX_C_SOURCE 200112L
+#include "Journal.h"
+#include "Record.h"
+#include "Utility.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+/* a Journal contains the file entries are appended to and the name of that file,
+which is needed to empty the file at a checkpoint */
+struct Journal {
+	FILE* file;
+	char filename[FILE_BUFFER_SIZE];
+};
+
+/* Create a Journal object writing to the named file, which is created or emptied.
+Returns NULL if the file could not be opened. */
+struct Journal* create_Journal(const char* filename)
+{
+	struct Journal *journal;
+	FILE *file = fopen(filename, "w");
+	if (!file)
+	{
+		return NULL;
+	}
+	journal = malloc(sizeof(struct Journal));
+	journal->file = file;
+	strcpy(journal->filename, filename);
+	return journal;
+}
+
+/* Destroy a Journal object, closing its file. */
+void destroy_Journal(struct Journal* journal_ptr)
+{
+	if (!journal_ptr)
+	{
+		return;
+	}
+	if (journal_ptr->file)
+	{
+		fclose(journal_ptr->file);
+	}
+	free(journal_ptr);
+}
+
+/* Discard all entries in the Journal; used when a snapshot has been saved or restored,
+because the snapshot then holds everything that the entries described. Returns non-zero
+if the file could not be emptied, in which case its entries are kept and journaling goes on. */
+int checkpoint_Journal(struct Journal* journal_ptr)
+{
+	FILE *file;
+	if (!journal_ptr)
+	{
+		return 0;
+	}
+	/* the old stream is only closed once the file has been opened again, unlike with freopen */
+	file = fopen(journal_ptr->filename, "w");
+	if (!file)
+	{
+		return 1;
+	}
+	fclose(journal_ptr->file);
+	journal_ptr->file = file;
+	return 0;
+}
+
+/* Return non-zero if the open file is the one the Journal is writing to. */
+int is_Journal_file(const struct Journal* journal_ptr, FILE* file)
+{
+	struct stat journal_status, file_status;
+	if (!journal_ptr || fstat(fileno(journal_ptr->file), &journal_status) != 0 || fstat(fileno(file), &file_status) != 0)
+	{
+		return 0;
+	}
+	return journal_status.st_dev == file_status.st_dev && journal_status.st_ino == file_status.st_ino;
+}
+
+/* Write an entry with printf-style formatting; the format must end the entry with a '\n'. */
+void journal_entry(struct Journal* journal_ptr, const char* format, ...)
+{
+	va_list args;
+	if (!journal_ptr || !journal_ptr->file)
+	{
+		return;
+	}
+	va_start(args, format);
+	vfprintf(journal_ptr->file, format, args);
+	va_end(args);
+	fflush(journal_ptr->file);
+}
+
+/* Write an entry for an added Record, containing all of its data. */
+void journal_record_entry(struct Journal* journal_ptr, const struct Record* record_ptr)
+{
+	if (!journal_ptr || !journal_ptr->file)
+	{
+		return;
+	}
+	fprintf(journal_ptr->file, "ar ");
+	save_Record(record_ptr, journal_ptr->file);
+	fflush(journal_ptr->file);
+}
@@ -0,0 +1,42 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+/* 
+A Journal is an opaque type for an append-only log of the commands that modify the
+library and catalog. Each entry is one line written in the same order as the
+corresponding command (e.g. "mr 3 5"), with records written in the save file format,
+so a snapshot written by sA plus the journal entries made after it reproduce the data.
+Every entry is flushed to the file as soon as it is written.
+
+All of the entry functions do nothing if given a NULL Journal pointer, so the caller
+can use a NULL pointer to mean that journaling is turned off.
+*/
+
+#include <stdio.h> /* for the declaration of FILE */
+
+/* incomplete declarations */
+struct Journal;
+struct Record;
+
+/* Create a Journal object writing to the named file, which is created or emptied.
+Returns NULL if the file could not be opened. */
+struct Journal* create_Journal(const char* filename);
+
+/* Destroy a Journal object, closing its file. */
+void destroy_Journal(struct Journal* journal_ptr);
+
+/* Discard all entries in the Journal; used when a snapshot has been saved or restored,
+because the snapshot then holds everything that the entries described. Returns non-zero
+if the file could not be emptied, in which case its entries are kept and journaling goes on. */
+int checkpoint_Journal(struct Journal* journal_ptr);
+
+/* Return non-zero if the open file is the one the Journal is writing to. */
+int is_Journal_file(const struct Journal* journal_ptr, FILE* file);
+
+/* Write an entry with printf-style formatting; the format must end the entry with a '\n'. */
+void journal_entry(struct Journal* journal_ptr, const char* format, ...);
+
+/* Write an entry for an added Record, containing all of its data. */
+void journal_record_entry(struct Journal* journal_ptr, const struct Record* record_ptr);
+
+#endif
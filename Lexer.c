@@ -0,0 +1,219 @@
+#include "Lexer.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#define LEXER_BUFFER_SIZE 65536
+
+/* a Lexer contains the stream, and a buffer with pointers to the next unread
+character and to the end of the characters read into it */
+struct Lexer {
+	FILE* stream;
+	int interactive;
+	int ran_out;		/* whether the input has been found to end since the last lex_take_line */
+	char* next;
+	char* end;
+	char buffer[LEXER_BUFFER_SIZE];
+};
+
+/* Refill the buffer from the stream; returns non-zero if any characters were read */
+static int lex_refill(struct Lexer* lexer_ptr);
+
+/* Return the next character without reading it, or EOF if the input has ended */
+static int lex_peek(struct Lexer* lexer_ptr);
+
+/* Create a Lexer object reading from the stream, which may be NULL; interactive is non-zero if 
+the stream is being typed by a user. */
+struct Lexer* create_Lexer(FILE* stream, int interactive)
+{
+	struct Lexer *lexer = malloc(sizeof(struct Lexer));
+	lexer->stream = stream;
+	lexer->interactive = interactive;
+	lexer->ran_out = 0;
+	lexer->next = lexer->buffer;
+	lexer->end = lexer->buffer;
+	return lexer;
+}
+
+/* Destroy a Lexer object; unread input in its buffer is discarded. */
+void destroy_Lexer(struct Lexer* lexer_ptr)
+{
+	free(lexer_ptr);
+}
+
+/* Read a character after skipping whitespace, like scanf(" %c").
+Returns 1 on success, 0 if the input ended first. */
+int lex_char(struct Lexer* lexer_ptr, char* char_ptr)
+{
+	lex_skip_whitespace(lexer_ptr);
+	if (lex_peek(lexer_ptr) == EOF)
+	{
+		return 0;
+	}
+	*char_ptr = *lexer_ptr->next++;
+	return 1;
+}
+
+/* Read a decimal integer after skipping whitespace, like scanf("%d").
+Returns 1 on success, 0 on failure. */
+int lex_int(struct Lexer* lexer_ptr, int* int_ptr)
+{
+	unsigned long value = 0;
+	int negative = 0;
+	int current;
+	lex_skip_whitespace(lexer_ptr);
+	current = lex_peek(lexer_ptr);
+	if (current == '-' || current == '+')
+	{
+		/* like scanf, a sign is read even if no digit follows it */
+		negative = current == '-';
+		lexer_ptr->next++;
+		current = lex_peek(lexer_ptr);
+	}
+	if (current == EOF || !isdigit(current))
+	{
+		return 0;
+	}
+	do
+	{
+		value = value * 10 + (current - '0');
+		lexer_ptr->next++;
+		current = lex_peek(lexer_ptr);
+	} while (current != EOF && isdigit(current));
+	*int_ptr = negative ? -(long)value : (long)value;
+	return 1;
+}
+
+/* Read a whitespace-delimited word of at most buffer_size - 1 characters 
+after skipping whitespace, like scanf("%Ns"). Returns 1 on success, 0 if the input ended first. */
+int lex_word(struct Lexer* lexer_ptr, char* buffer, int buffer_size)
+{
+	int current;
+	int length = 0;
+	lex_skip_whitespace(lexer_ptr);
+	current = lex_peek(lexer_ptr);
+	if (current == EOF)
+	{
+		return 0;
+	}
+	while (length < buffer_size - 1 && current != EOF && !isspace(current))
+	{
+		buffer[length++] = *lexer_ptr->next++;
+		current = lex_peek(lexer_ptr);
+	}
+	buffer[length] = '\0';
+	return 1;
+}
+
+/* Read the rest of the line including the '\n', but at most buffer_size - 1 characters, 
+like fgets. Returns 1 on success, 0 if the input ended first. */
+int lex_line(struct Lexer* lexer_ptr, char* buffer, int buffer_size)
+{
+	int length = 0;
+	if (lex_peek(lexer_ptr) == EOF)
+	{
+		return 0;
+	}
+	while (length < buffer_size - 1 && lex_peek(lexer_ptr) != EOF)
+	{
+		char current = *lexer_ptr->next++;
+		buffer[length++] = current;
+		if (current == '\n')
+		{
+			break;
+		}
+	}
+	buffer[length] = '\0';
+	return 1;
+}
+
+/* Replace the input of a Lexer without a stream by the rest of the line read from the source Lexer,
+including the '\n'; the end of a line too long for the buffer is skipped. Returns 1 on success,
+0 if the source's input ended first. */
+int lex_take_line(struct Lexer* lexer_ptr, struct Lexer* source_ptr)
+{
+	lexer_ptr->ran_out = 0;
+	if (!lex_line(source_ptr, lexer_ptr->buffer, LEXER_BUFFER_SIZE))
+	{
+		lexer_ptr->next = lexer_ptr->end = lexer_ptr->buffer;
+		return 0;
+	}
+	lexer_ptr->next = lexer_ptr->buffer;
+	lexer_ptr->end = lexer_ptr->buffer + strlen(lexer_ptr->buffer);
+	if (lexer_ptr->end == lexer_ptr->buffer || lexer_ptr->end[-1] != '\n')
+	{
+		lex_skip_line(source_ptr);
+	}
+	return 1;
+}
+
+/* Return non-zero if a read has found the end of the input since the Lexer was
+created or last given a line by lex_take_line. */
+int lex_ran_out(const struct Lexer* lexer_ptr)
+{
+	return lexer_ptr->ran_out;
+}
+
+/* Return the next character after skipping whitespace, without reading it,
+or EOF if the input ended first. */
+int lex_peek_char(struct Lexer* lexer_ptr)
+{
+	lex_skip_whitespace(lexer_ptr);
+	return lex_peek(lexer_ptr);
+}
+
+/* Skip any whitespace, like a space in a scanf format. */
+void lex_skip_whitespace(struct Lexer* lexer_ptr)
+{
+	int current;
+	while ((current = lex_peek(lexer_ptr)) != EOF && isspace(current))
+	{
+		lexer_ptr->next++;
+	}
+}
+
+/* Skip the rest of the line including the '\n'. */
+void lex_skip_line(struct Lexer* lexer_ptr)
+{
+	while (lex_peek(lexer_ptr) != EOF)
+	{
+		if (*lexer_ptr->next++ == '\n')
+		{
+			return;
+		}
+	}
+}
+
+/* Refill the buffer from the stream; returns non-zero if any characters were read */
+static int lex_refill(struct Lexer* lexer_ptr)
+{
+	size_t count;
+	if (!lexer_ptr->stream)
+	{
+		count = 0;
+	}
+	else if (lexer_ptr->interactive)
+	{
+		/* only wait for the line that the user is typing */
+		count = fgets(lexer_ptr->buffer, LEXER_BUFFER_SIZE, lexer_ptr->stream) ? strlen(lexer_ptr->buffer) : 0;
+	}
+	else
+	{
+		count = fread(lexer_ptr->buffer, 1, LEXER_BUFFER_SIZE, lexer_ptr->stream);
+	}
+	lexer_ptr->next = lexer_ptr->buffer;
+	lexer_ptr->end = lexer_ptr->buffer + count;
+	return count > 0;
+}
+
+/* Return the next character without reading it, or EOF if the input has ended */
+static int lex_peek(struct Lexer* lexer_ptr)
+{
+	if (lexer_ptr->next == lexer_ptr->end && !lex_refill(lexer_ptr))
+	{
+		lexer_ptr->ran_out = 1;
+		return EOF;
+	}
+	return (unsigned char)*lexer_ptr->next;
+}
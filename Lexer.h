@@ -0,0 +1,64 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+/* 
+A Lexer is an opaque type that reads the tokens of commands and save files from a 
+stream through a large buffer, so that reading a token does not make a stdio call. 
+Each reading function treats the input in the same way as the scanf conversion
+named in its comment, including which characters are left unread when it fails.
+
+An interactive Lexer refills its buffer one line at a time, so that it never waits
+for more input than the user has typed; otherwise the buffer is refilled with as
+much of the stream as fits. The stream must not be read except through the Lexer
+while the Lexer is in use, and it is not closed when the Lexer is destroyed.
+A Lexer without a stream reads only the lines that lex_take_line gives it.
+*/
+
+#include <stdio.h> /* for the declaration of FILE */
+
+/* incomplete declaration */
+struct Lexer;
+
+/* Create a Lexer object reading from the stream, which may be NULL; interactive is non-zero if 
+the stream is being typed by a user. */
+struct Lexer* create_Lexer(FILE* stream, int interactive);
+
+/* Destroy a Lexer object; unread input in its buffer is discarded. */
+void destroy_Lexer(struct Lexer* lexer_ptr);
+
+/* Read a character after skipping whitespace, like scanf(" %c").
+Returns 1 on success, 0 if the input ended first. */
+int lex_char(struct Lexer* lexer_ptr, char* char_ptr);
+
+/* Read a decimal integer after skipping whitespace, like scanf("%d").
+Returns 1 on success, 0 on failure. */
+int lex_int(struct Lexer* lexer_ptr, int* int_ptr);
+
+/* Read a whitespace-delimited word of at most buffer_size - 1 characters 
+after skipping whitespace, like scanf("%Ns"). Returns 1 on success, 0 if the input ended first. */
+int lex_word(struct Lexer* lexer_ptr, char* buffer, int buffer_size);
+
+/* Read the rest of the line including the '\n', but at most buffer_size - 1 characters, 
+like fgets. Returns 1 on success, 0 if the input ended first. */
+int lex_line(struct Lexer* lexer_ptr, char* buffer, int buffer_size);
+
+/* Replace the input of a Lexer without a stream by the rest of the line read from the source Lexer,
+including the '\n'; the end of a line too long for the buffer is skipped. Returns 1 on success,
+0 if the source's input ended first. */
+int lex_take_line(struct Lexer* lexer_ptr, struct Lexer* source_ptr);
+
+/* Return non-zero if a read has found the end of the input since the Lexer was
+created or last given a line by lex_take_line. */
+int lex_ran_out(const struct Lexer* lexer_ptr);
+
+/* Return the next character after skipping whitespace, without reading it,
+or EOF if the input ended first. */
+int lex_peek_char(struct Lexer* lexer_ptr);
+
+/* Skip any whitespace, like a space in a scanf format. */
+void lex_skip_whitespace(struct Lexer* lexer_ptr);
+
+/* Skip the rest of the line including the '\n'. */
+void lex_skip_line(struct Lexer* lexer_ptr);
+
+#endif
@@ -0,0 +1,311 @@
+#include "Library.h"
+#include "Record.h"
+#include "Ordered_container.h"
+#include "Utility.h"
+#include <stdlib.h>
+
+#define ORDERING_LARGE_ALLOCATION 65536	/* Records in the smallest ordering array that is mapped */
+#define ORDERING_SHRINK_DIVISOR 4
+#define TITLE_ORDERING_BACKEND OC_ADAPTIVE_BACKEND	/* the title ordering is inserted into and searched often */
+#define INDEX_REBUILD_DIVISOR 16	/* indexes are rebuilt when more than this fraction of the Records are removed at once */
+
+/* the orderings hold every Record, so large ones are searched with huge pages */
+static const struct OC_allocation_policy ordering_policy = { ORDERING_LARGE_ALLOCATION, 1, ORDERING_SHRINK_DIVISOR };
+
+/* a registered index and the functions that keep it up to date */
+struct Library_index {
+	void* index_ptr;
+	Library_index_fp_t add_func;
+	Library_index_fp_t remove_func;
+	Library_index_clear_fp_t clear_func;
+	Library_index_fp_t rate_func;	/* NULL if a re-rated Record is removed and added again */
+	int uses_rating;
+};
+
+/* Records collected into an array */
+struct Record_array {
+	struct Record** records;
+	int count;
+};
+
+/* the function selecting the Records being removed, and the Records it has selected */
+struct Record_selection {
+	Library_select_fp_t select_func;
+	void* arg_ptr;
+	struct Record_array selected;
+};
+
+/* a Library contains the containers of Records in title and ID order, which own the Records,
+and an array of the registered indexes */
+struct Library {
+	struct Ordered_container* by_title;
+	struct Ordered_container* by_ID;
+	struct Library_index* indexes;
+	int index_count;
+};
+
+/* Used to destroy all records in an Ordered container */
+static void record_destroy(void* record_ptr);
+
+/* Compare pointers to records by the records' ids, for use with qsort */
+static int record_ptr_compare_id(const void* first_record_ptr, const void* second_record_ptr);
+
+/* Add a record to the end of a Record_array */
+static void record_array_append(void* record_ptr, void* array_ptr);
+
+/* Return non-zero if the selection function selects the record, adding it to the selected records */
+static int record_select(void* record_ptr, void* selection_ptr);
+
+/* Return non-zero if the record is in the Record_array, which is sorted by ID */
+static int record_array_contains(void* record_ptr, void* array_ptr);
+
+/* Add a record to a registered index */
+static void library_index_add(void* record_ptr, void* index_ptr);
+
+/* Create an empty Library object. A program with every implementation of Ordered_container keeps
+the title ordering in the adaptive one; if lazy_titles is non-zero, it is a lazy container, and
+the Library must then be used by only one thread at a time. */
+struct Library* create_Library(int lazy_titles)
+{
+	struct Library *library = malloc(sizeof(struct Library));
+	library->by_title = lazy_titles ? OC_create_lazy_container_backend(record_compare_title, TITLE_ORDERING_BACKEND)
+		: OC_create_container_backend(record_compare_title, TITLE_ORDERING_BACKEND);
+	library->by_ID = OC_create_container_backend(record_compare_id, OC_ARRAY_BACKEND);
+	OC_set_allocation_policy(library->by_title, &ordering_policy);
+	OC_set_allocation_policy(library->by_ID, &ordering_policy);
+	library->indexes = NULL;
+	library->index_count = 0;
+	return library;
+}
+
+/* Destroy a Library object and all of its Records; the registered indexes are not destroyed. */
+void destroy_Library(struct Library* library_ptr)
+{
+	clear_Library(library_ptr);
+	OC_destroy_container(library_ptr->by_title);
+	OC_destroy_container(library_ptr->by_ID);
+	free(library_ptr->indexes);
+	free(library_ptr);
+}
+
+/* Register an index, which must be empty if the Library is not; uses_rating is non-zero if
+the index must be told when a Record's rating changes. */
+void register_Library_index(struct Library* library_ptr, void* index_ptr, Library_index_fp_t add_func,
+	Library_index_fp_t remove_func, Library_index_clear_fp_t clear_func, int uses_rating)
+{
+	struct Library_index *index;
+	library_ptr->indexes = realloc(library_ptr->indexes, (library_ptr->index_count + 1) * sizeof(struct Library_index));
+	index = &library_ptr->indexes[library_ptr->index_count++];
+	index->index_ptr = index_ptr;
+	index->add_func = add_func;
+	index->remove_func = remove_func;
+	index->clear_func = clear_func;
+	index->rate_func = NULL;
+	index->uses_rating = uses_rating;
+}
+
+/* Give a registered index a function that updates a Record in it once the Record's rating
+has changed, which is called instead of removing and adding the Record again. */
+void set_Library_index_rate_func(struct Library* library_ptr, void* index_ptr, Library_index_fp_t rate_func)
+{
+	int i;
+	for (i = 0; i < library_ptr->index_count; i++)
+	{
+		if (library_ptr->indexes[i].index_ptr == index_ptr)
+		{
+			library_ptr->indexes[i].rate_func = rate_func;
+		}
+	}
+}
+
+/* Return the container of the Records in title order; it must not be modified directly. */
+struct Ordered_container* get_Library_by_title(const struct Library* library_ptr)
+{
+	return library_ptr->by_title;
+}
+
+/* Return the container of the Records in ID order; it must not be modified directly. */
+struct Ordered_container* get_Library_by_ID(const struct Library* library_ptr)
+{
+	return library_ptr->by_ID;
+}
+
+/* Add a Record to the Library, which owns it from then on. */
+void insert_Library_record(struct Library* library_ptr, struct Record* record_ptr)
+{
+	int i;
+	OC_insert(library_ptr->by_title, record_ptr);
+	OC_insert(library_ptr->by_ID, record_ptr);
+	for (i = 0; i < library_ptr->index_count; i++)
+	{
+		library_ptr->indexes[i].add_func(library_ptr->indexes[i].index_ptr, record_ptr);
+	}
+}
+
+/* Add many Records at once, each with a title not already in the Library. Records that come
+in title order are each put at the end of the title ordering, and the ID ordering and the 
+indexes are given the Records sorted by ID, so each of them goes at the end there as well. */
+void insert_Library_records(struct Library* library_ptr, struct Record** records, int count)
+{
+	struct Record **sorted;
+	int i, j;
+	if (count <= 0)
+	{
+		return;
+	}
+	sorted = malloc(count * sizeof(struct Record *));
+	for (i = 0; i < count; i++)
+	{
+		OC_insert(library_ptr->by_title, records[i]);
+		sorted[i] = records[i];
+	}
+	qsort(sorted, count, sizeof(struct Record *), record_ptr_compare_id);
+	for (i = 0; i < count; i++)
+	{
+		OC_insert(library_ptr->by_ID, sorted[i]);
+		for (j = 0; j < library_ptr->index_count; j++)
+		{
+			library_ptr->indexes[j].add_func(library_ptr->indexes[j].index_ptr, sorted[i]);
+		}
+	}
+	free(sorted);
+}
+
+/* Remove a Record from the Library and destroy it, given its item in the title ordering. */
+void erase_Library_record(struct Library* library_ptr, void* title_item_ptr)
+{
+	struct Record *record = OC_get_data_ptr(title_item_ptr);
+	int ID = get_Record_ID(record);
+	int i;
+	for (i = 0; i < library_ptr->index_count; i++)
+	{
+		library_ptr->indexes[i].remove_func(library_ptr->indexes[i].index_ptr, record);
+	}
+	/* the title item is already known; the ID ordering is searched by ID rather than by Record */
+	OC_delete_item(library_ptr->by_title, title_item_ptr);
+	OC_delete_item(library_ptr->by_ID, OC_find_item_arg(library_ptr->by_ID, &ID, record_id_compare));
+	destroy_Record(record);
+}
+
+/* Remove and destroy every Record the function selects, and return the number removed. */
+int erase_Library_records_if(struct Library* library_ptr, Library_select_fp_t select_func, void* arg_ptr)
+{
+	struct Record_selection selection;
+	int size = OC_get_size(library_ptr->by_title);
+	int i, j;
+	selection.select_func = select_func;
+	selection.arg_ptr = arg_ptr;
+	selection.selected.records = malloc((size + 1) * sizeof(struct Record *));
+	selection.selected.count = 0;
+	OC_remove_if(library_ptr->by_title, record_select, &selection);
+	/* the selected Records are sorted by ID so that the ID ordering can look each of its Records up */
+	qsort(selection.selected.records, selection.selected.count, sizeof(struct Record *), record_ptr_compare_id);
+	OC_remove_if(library_ptr->by_ID, record_array_contains, &selection.selected);
+	/* removing a Record from an index can take time in proportion to its size, so after removing
+	many the indexes are instead cleared and given the remaining Records again, in ID order */
+	for (j = 0; j < library_ptr->index_count; j++)
+	{
+		if (selection.selected.count * INDEX_REBUILD_DIVISOR > size)
+		{
+			library_ptr->indexes[j].clear_func(library_ptr->indexes[j].index_ptr);
+			OC_apply_arg(library_ptr->by_ID, library_index_add, &library_ptr->indexes[j]);
+		}
+		else
+		{
+			for (i = 0; i < selection.selected.count; i++)
+			{
+				library_ptr->indexes[j].remove_func(library_ptr->indexes[j].index_ptr, selection.selected.records[i]);
+			}
+		}
+	}
+	for (i = 0; i < selection.selected.count; i++)
+	{
+		destroy_Record(selection.selected.records[i]);
+	}
+	free(selection.selected.records);
+	return selection.selected.count;
+}
+
+/* Change the rating of a Record in the Library. */
+void modify_Library_record_rating(struct Library* library_ptr, struct Record* record_ptr, int rating)
+{
+	int i;
+	for (i = 0; i < library_ptr->index_count; i++)
+	{
+		if (library_ptr->indexes[i].uses_rating && !library_ptr->indexes[i].rate_func)
+		{
+			library_ptr->indexes[i].remove_func(library_ptr->indexes[i].index_ptr, record_ptr);
+		}
+	}
+	set_Record_rating(record_ptr, rating);
+	for (i = 0; i < library_ptr->index_count; i++)
+	{
+		if (library_ptr->indexes[i].rate_func)
+		{
+			library_ptr->indexes[i].rate_func(library_ptr->indexes[i].index_ptr, record_ptr);
+		}
+		else if (library_ptr->indexes[i].uses_rating)
+		{
+			library_ptr->indexes[i].add_func(library_ptr->indexes[i].index_ptr, record_ptr);
+		}
+	}
+}
+
+/* Remove and destroy all of the Records, and reset the counter for the next ID number. */
+void clear_Library(struct Library* library_ptr)
+{
+	int i;
+	for (i = 0; i < library_ptr->index_count; i++)
+	{
+		library_ptr->indexes[i].clear_func(library_ptr->indexes[i].index_ptr);
+	}
+	OC_apply(library_ptr->by_title, record_destroy);
+	OC_clear(library_ptr->by_title);
+	OC_clear(library_ptr->by_ID);
+	reset_Record_ID_counter();
+}
+
+/* Used to destroy all records in an Ordered container */
+static void record_destroy(void* record_ptr)
+{
+	destroy_Record(record_ptr);
+}
+
+/* Compare pointers to records by the records' ids, for use with qsort */
+static int record_ptr_compare_id(const void* first_record_ptr, const void* second_record_ptr)
+{
+	return record_compare_id(*(void * const *)first_record_ptr, *(void * const *)second_record_ptr);
+}
+
+/* Add a record to the end of a Record_array */
+static void record_array_append(void* record_ptr, void* array_ptr)
+{
+	struct Record_array *array = array_ptr;
+	array->records[array->count++] = record_ptr;
+}
+
+/* Return non-zero if the selection function selects the record, adding it to the selected records */
+static int record_select(void* record_ptr, void* selection_ptr)
+{
+	struct Record_selection *selection = selection_ptr;
+	if (!selection->select_func(record_ptr, selection->arg_ptr))
+	{
+		return 0;
+	}
+	record_array_append(record_ptr, &selection->selected);
+	return 1;
+}
+
+/* Return non-zero if the record is in the Record_array, which is sorted by ID */
+static int record_array_contains(void* record_ptr, void* array_ptr)
+{
+	struct Record_array *array = array_ptr;
+	return bsearch(&record_ptr, array->records, array->count, sizeof(struct Record *), record_ptr_compare_id) != NULL;
+}
+
+/* Add a record to a registered index */
+static void library_index_add(void* record_ptr, void* index_ptr)
+{
+	struct Library_index *index = index_ptr;
+	index->add_func(index->index_ptr, record_ptr);
+}
@@ -0,0 +1,77 @@
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+/* 
+A Library is an opaque type that owns the Records and keeps every ordering and index of them
+consistent. The Records are kept in two Ordered_containers, in title order and in ID order,
+and any number of other indexes can be registered with the Library. Records are only added,
+removed, or re-rated through the Library, and each of these calls updates every ordering and
+index at once.
+
+A registered index is given each Record as it is added or removed, and is cleared when the
+Library is. An index that uses the rating is also given a re-rated Record: it is removed
+with its old rating and added again with its new one, unless the index has a rate function,
+which is given the Record once its rating has changed so the index can update it in place.
+*/
+
+/* incomplete declarations */
+struct Library;
+struct Record;
+struct Ordered_container;
+
+/* type of the functions that add a Record to a registered index or remove one from it */
+typedef void (*Library_index_fp_t) (void* index_ptr, struct Record* record_ptr);
+
+/* type of the function that removes all Records from a registered index */
+typedef void (*Library_index_clear_fp_t) (void* index_ptr);
+
+/* type of the function that selects the Records to be removed, given the supplied argument;
+it returns non-zero for a Record that is to be removed */
+typedef int (*Library_select_fp_t) (struct Record* record_ptr, void* arg_ptr);
+
+/* Create an empty Library object. A program with every implementation of Ordered_container keeps
+the title ordering in the adaptive one; if lazy_titles is non-zero, it is a lazy container, and
+the Library must then be used by only one thread at a time. */
+struct Library* create_Library(int lazy_titles);
+
+/* Destroy a Library object and all of its Records; the registered indexes are not destroyed. */
+void destroy_Library(struct Library* library_ptr);
+
+/* Register an index, which must be empty if the Library is not; uses_rating is non-zero if
+the index must be told when a Record's rating changes. */
+void register_Library_index(struct Library* library_ptr, void* index_ptr, Library_index_fp_t add_func,
+	Library_index_fp_t remove_func, Library_index_clear_fp_t clear_func, int uses_rating);
+
+/* Give a registered index a function that updates a Record in it once the Record's rating
+has changed, which is called instead of removing and adding the Record again. */
+void set_Library_index_rate_func(struct Library* library_ptr, void* index_ptr, Library_index_fp_t rate_func);
+
+/* Return the container of the Records in title order; it must not be modified directly. */
+struct Ordered_container* get_Library_by_title(const struct Library* library_ptr);
+
+/* Return the container of the Records in ID order; it must not be modified directly. */
+struct Ordered_container* get_Library_by_ID(const struct Library* library_ptr);
+
+/* Add a Record to the Library, which owns it from then on. */
+void insert_Library_record(struct Library* library_ptr, struct Record* record_ptr);
+
+/* Add many Records at once, each with a title not already in the Library. Records that come
+in title order are each put at the end of the title ordering, and the ID ordering and the 
+indexes are given the Records sorted by ID, so each of them goes at the end there as well. */
+void insert_Library_records(struct Library* library_ptr, struct Record** records, int count);
+
+/* Remove a Record from the Library and destroy it, given its item in the title ordering. */
+void erase_Library_record(struct Library* library_ptr, void* title_item_ptr);
+
+/* Remove and destroy every Record the function selects, and return the number removed. Each
+ordering is compacted once, rather than once for each Record, and if many Records are removed
+the indexes are rebuilt from the rest, so removing them costs about one pass over the Library. */
+int erase_Library_records_if(struct Library* library_ptr, Library_select_fp_t select_func, void* arg_ptr);
+
+/* Change the rating of a Record in the Library. */
+void modify_Library_record_rating(struct Library* library_ptr, struct Record* record_ptr, int rating);
+
+/* Remove and destroy all of the Records, and reset the counter for the next ID number. */
+void clear_Library(struct Library* library_ptr);
+
+#endif
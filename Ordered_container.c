@@ -0,0 +1,146 @@
+#include "Ordered_container_backend.h"
+#include "p1_globals.h"
+
+/* This file is only linked into a program built with OC_RUNTIME_BACKENDS defined, with all the
+implementations; each function calls the one of the container's implementation through its table. */
+
+#define OC_DEFAULT_BACKEND OC_ARRAY_BACKEND
+
+/* the table of a container's implementation, which is the first member of the container */
+#define OC_OPS(c_ptr) (*(const struct OC_ops* const*)(c_ptr))
+
+/* These global variables are used to monitor the memory usage of the Ordered_container */
+int g_Container_count = 0;				/* number of Ordered_containers currently allocated */
+int g_Container_items_in_use = 0;		/* number of Ordered_container items currently in use */
+int g_Container_items_allocated = 0;	/* number of Ordered_container items currently allocated */
+int g_Container_promotions = 0;			/* number of times an Ordered_container has become a tree */
+int g_Container_demotions = 0;			/* number of times an Ordered_container has become an array */
+
+/* the tables of the implementations, in the order of enum OC_backend */
+static const struct OC_ops* const backend_ops[] = { &OC_list_ops, &OC_array_ops, &OC_lsm_ops, &OC_adaptive_ops };
+
+/* Create an empty container using the supplied comparison function, and return the pointer to it. */
+struct Ordered_container* OC_create_container(OC_comp_fp_t f_ptr)
+{
+	return backend_ops[OC_DEFAULT_BACKEND]->create_container(f_ptr);
+}
+
+/* Create an empty container using the supplied comparison function and implementation,
+and return the pointer to it. */
+struct Ordered_container* OC_create_container_backend(OC_comp_fp_t f_ptr, enum OC_backend backend)
+{
+	return backend_ops[backend]->create_container(f_ptr);
+}
+
+/* Create an empty lazy container using the supplied comparison function, and return the pointer to it. */
+struct Ordered_container* OC_create_lazy_container(OC_comp_fp_t f_ptr)
+{
+	return backend_ops[OC_DEFAULT_BACKEND]->create_lazy_container(f_ptr);
+}
+
+/* Create an empty lazy container using the supplied comparison function and implementation,
+and return the pointer to it. */
+struct Ordered_container* OC_create_lazy_container_backend(OC_comp_fp_t f_ptr, enum OC_backend backend)
+{
+	return backend_ops[backend]->create_lazy_container(f_ptr);
+}
+
+/* Destroy the container and its items; caller is responsible for
+deleting all pointed-to data before calling this function.
+After this call, the container pointer value must not be used again. */
+void OC_destroy_container(struct Ordered_container* c_ptr)
+{
+	OC_OPS(c_ptr)->destroy_container(c_ptr);
+}
+
+/* Delete all the items in the container and initialize it.
+Caller is responsible for deleting any pointed-to data first. */
+void OC_clear(struct Ordered_container* c_ptr)
+{
+	OC_OPS(c_ptr)->clear(c_ptr);
+}
+
+/* Return the number of items currently stored in the container */
+int OC_get_size(const struct Ordered_container* c_ptr)
+{
+	return OC_OPS(c_ptr)->get_size(c_ptr);
+}
+
+/* Return non-zero (true) if the container is empty, zero (false) if the container is non-empty */
+int OC_empty(const struct Ordered_container* c_ptr)
+{
+	return OC_OPS(c_ptr)->empty(c_ptr);
+}
+
+/* Set how the container allocates memory for its items. */
+void OC_set_allocation_policy(struct Ordered_container* c_ptr, const struct OC_allocation_policy* policy_ptr)
+{
+	OC_OPS(c_ptr)->set_allocation_policy(c_ptr, policy_ptr);
+}
+
+/* Get the data object pointer from an item. */
+void* OC_get_data_ptr(const void* item_ptr)
+{
+	return *(void* const*)item_ptr;
+}
+
+/* Delete the specified item.
+Caller is responsible for any deletion of the data pointed to by the item. */
+void OC_delete_item(struct Ordered_container* c_ptr, void* item_ptr)
+{
+	OC_OPS(c_ptr)->delete_item(c_ptr, item_ptr);
+}
+
+/* Create a new item for the specified data pointer and put it in the container in order. */
+void OC_insert(struct Ordered_container* c_ptr, const void* data_ptr)
+{
+	OC_OPS(c_ptr)->insert(c_ptr, data_ptr);
+}
+
+/* Return a pointer to an item that points to data equal to the data object pointed to by data_ptr,
+or NULL if no matching item is found. */
+void* OC_find_item(const struct Ordered_container* c_ptr, const void* data_ptr)
+{
+	return OC_OPS(c_ptr)->find_item(c_ptr, data_ptr);
+}
+
+/* Return a pointer to the item that points to data that matches the supplied argument given by arg_ptr
+according to the supplied function, or NULL if no matching item is found. */
+void* OC_find_item_arg(const struct Ordered_container* c_ptr, const void* arg_ptr, OC_find_item_arg_fp_t fafp)
+{
+	return OC_OPS(c_ptr)->find_item_arg(c_ptr, arg_ptr, fafp);
+}
+
+/* Apply the supplied function to the data pointer in each item of the container. */
+void OC_apply(const struct Ordered_container* c_ptr, OC_apply_fp_t afp)
+{
+	OC_OPS(c_ptr)->apply(c_ptr, afp);
+}
+
+/* Apply the supplied function to the data pointer in each item in the container,
+stopping at and returning the first non-zero value it returns. */
+int OC_apply_if(const struct Ordered_container* c_ptr, OC_apply_if_fp_t afp)
+{
+	return OC_OPS(c_ptr)->apply_if(c_ptr, afp);
+}
+
+/* Apply the supplied function to the data pointer in each item in the container,
+with the supplied void pointer as its second argument. */
+void OC_apply_arg(const struct Ordered_container* c_ptr, OC_apply_arg_fp_t afp, void* arg_ptr)
+{
+	OC_OPS(c_ptr)->apply_arg(c_ptr, afp, arg_ptr);
+}
+
+/* Apply the supplied function to the data pointer in each item in the container, with the
+supplied void pointer as its second argument, stopping at and returning the first non-zero value it returns. */
+int OC_apply_if_arg(const struct Ordered_container* c_ptr, OC_apply_if_arg_fp_t afp, void* arg_ptr)
+{
+	return OC_OPS(c_ptr)->apply_if_arg(c_ptr, afp, arg_ptr);
+}
+
+/* Remove every item for whose data pointer the supplied function returns non-zero,
+and return the number of items removed. */
+int OC_remove_if(struct Ordered_container* c_ptr, OC_apply_if_arg_fp_t afp, void* arg_ptr)
+{
+	return OC_OPS(c_ptr)->remove_if(c_ptr, afp, arg_ptr);
+}
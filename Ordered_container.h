@@ -39,6 +39,21 @@ is responsible for deallocating the pointed-to data object, if necessary, before
 Note that a previously obtained pointer to an item in the container can be invalidated 
 if items are then added or removed from the container.
 
+A lazy container, created with OC_create_lazy_container, puts each inserted item that does not
+belong at the end into an unsorted tail instead of searching for its place, so that many
+insertions in a row do not each pay for keeping the container in order. The tail is sorted
+and merged into the other items when they are next needed in order: by the apply functions,
+and in the array implementation by a find function if the tail has grown too long to be
+searched item by item, or in the list implementation by OC_delete_item. Merging can invalidate previously obtained
+item pointers, and modifies the container even though these functions declare it const,
+so a lazy container must not be used by two of them at the same time.
+
+A program is normally linked with one implementation of these functions, and every container
+uses it. A program built with OC_RUNTIME_BACKENDS defined is instead linked with all of them
+and with Ordered_container.c, which calls the implementation each container was created with
+through a table of functions. OC_create_container_backend chooses the implementation for a
+new container; OC_create_container and OC_create_lazy_container use the array implementation.
+
 The Ordered_container functions manage the memory for the container object itself and the items; 
 the user must never call the free function with either an Ordered_container
 pointer or an item pointer.
@@ -85,6 +100,8 @@ struct Ordered_container;
 extern int g_Container_count;		/* number of Ordered_containers currently allocated */
 extern int g_Container_items_in_use;	/* number of Ordered_container items currently in use */
 extern int g_Container_items_allocated;	/* number of Ordered_container items currently allocated */
+extern int g_Container_promotions;		/* number of times an Ordered_container has become a tree */
+extern int g_Container_demotions;		/* number of times an Ordered_container has become an array */
 
 
 /* Type of comparison function to specify the order of items in an Ordered_container.
@@ -95,6 +112,10 @@ items pointing to the data objects are then placed in the corresponding order in
 typedef int (*OC_comp_fp_t) (const void* data_ptr1, const void* data_ptr2);
 
 
+/* The implementations of Ordered_container */
+enum OC_backend { OC_LIST_BACKEND, OC_ARRAY_BACKEND, OC_LSM_BACKEND, OC_ADAPTIVE_BACKEND };
+
+
 /*
 Functions for the entire container.
 */
@@ -102,6 +123,17 @@ Functions for the entire container.
 /* Create an empty container using the supplied comparison function, and return the pointer to it. */
 struct Ordered_container* OC_create_container(OC_comp_fp_t f_ptr);
 
+/* Create an empty container using the supplied comparison function and implementation,
+and return the pointer to it. A program linked with only one implementation uses it for every backend. */
+struct Ordered_container* OC_create_container_backend(OC_comp_fp_t f_ptr, enum OC_backend backend);
+
+/* Create an empty lazy container using the supplied comparison function, and return the pointer to it. */
+struct Ordered_container* OC_create_lazy_container(OC_comp_fp_t f_ptr);
+
+/* Create an empty lazy container using the supplied comparison function and implementation,
+and return the pointer to it. A program linked with only one implementation uses it for every backend. */
+struct Ordered_container* OC_create_lazy_container_backend(OC_comp_fp_t f_ptr, enum OC_backend backend);
+
 /* Destroy the container and its items; caller is responsible for 
 deleting all pointed-to data before calling this function. 
 After this call, the container pointer value must not be used again. */
@@ -117,6 +149,23 @@ int OC_get_size(const struct Ordered_container* c_ptr);
 /* Return non-zero (true) if the container is empty, zero (false) if the container is non-empty */
 int OC_empty(const struct Ordered_container* c_ptr);
 
+/* How the array implementation allocates the array of a container; the others ignore it.
+An array of at least large_allocation items is mapped directly from the system, so that it can
+grow or shrink in place without copying, and with huge_pages non-zero it is given huge pages
+where the system supports them, so that searching it needs fewer address translations.
+Such an array is halved whenever fewer than 1 / shrink_divisor of its items are in use. 
+A large_allocation or shrink_divisor of zero turns that behavior off. */
+struct OC_allocation_policy {
+	int large_allocation;
+	int huge_pages;
+	int shrink_divisor;
+};
+
+/* Set how the container allocates memory for its items; the policy takes effect when the
+container next allocates, and until then a container uses the default: arrays of 65536 items
+or more are mapped without huge pages, and shrunk when less than a quarter full. */
+void OC_set_allocation_policy(struct Ordered_container* c_ptr, const struct OC_allocation_policy* policy_ptr);
+
 /*
 Functions for working with individual items in the container.
 */
@@ -211,4 +260,11 @@ If the function returns non-zero, the iteration is terminated, and that value
 returned. Otherwise, zero is returned. The contents of the container cannot be modified */
 int OC_apply_if_arg(const struct Ordered_container* c_ptr, OC_apply_if_arg_fp_t afp, void* arg_ptr);
 
+/* Remove every item for whose data pointer the supplied function returns non-zero, and return
+the number of items removed; the function takes a second argument, which is the supplied void pointer.
+The function is called once for each item, but not necessarily in order, and may use the argument
+to keep the data pointers of the removed items, since the caller is responsible for their deletion.
+The remaining items are moved together once, instead of once for each removed item. */
+int OC_remove_if(struct Ordered_container* c_ptr, OC_apply_if_arg_fp_t afp, void* arg_ptr);
+
 #endif
@@ -0,0 +1,757 @@
+#ifndef ORDERED_CONTAINER_ADAPTIVE
+#define ORDERED_CONTAINER_ADAPTIVE
+
+#define OC_BACKEND_PREFIX OC_adaptive_
+#include "Ordered_container_backend.h"
+#include "Utility.h"
+#include "p1_globals.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define INLINE_CAPACITY 8	/* cells of a small array kept in the container object itself */
+#define PROMOTE_SIZE 64		/* size beyond which an array may become a tree */
+#define DEMOTE_SIZE 16		/* size below which a tree always becomes an array */
+
+/* Finds may be done by many threads at once, in a container that is only changed while no other
+thread uses it, so a find is counted with an atomic increment; without one, finds are not counted,
+and the representation is then chosen from the size and the changes alone. */
+#ifdef __GNUC__
+#define COUNT_FIND(c_ptr) __atomic_fetch_add(&((struct Ordered_container*)(c_ptr))->finds, 1, __ATOMIC_RELAXED)
+#else
+#define COUNT_FIND(c_ptr)
+#endif
+
+/* A node of the tree; the data pointer comes first, so that an item pointer to either a node or
+an array cell points to the data pointer */
+struct Node {
+	void* data_ptr;
+	struct Node* left;
+	struct Node* right;
+	struct Node* parent;
+	int height;
+};
+
+/* A complete type declaration for Ordered_container that is either a sorted array, whose cells
+are in the container object while there are few enough of them, or an AVL tree.
+The container counts the items inserted or deleted and the finds done recently, and after
+each insertion or deletion decides from the size and these counts which representation to use:
+an array is cheaper to search, but a tree is cheaper to change once it is large. */
+struct Ordered_container {
+	OC_OPS_MEMBER
+	OC_comp_fp_t comp_fun;	/* pointer to comparison function  */
+	void** cells;			/* the array, or NULL if the container is a tree */
+	void* inline_cells[INLINE_CAPACITY];
+	int allocation;			/* number of cells in the array */
+	struct Node* root;
+	int size;
+	int changes;			/* recent insertions and deletions */
+	int finds;				/* recent finds, counted with COUNT_FIND */
+};
+
+/* Enum for OC_apply functions */
+typedef enum { APPLY, APPLY_IF, APPLY_ARG, APPLY_ARG_IF } apply_enum;
+
+/* These global variables are used to monitor the memory usage of the Ordered_container */
+#ifndef OC_RUNTIME_BACKENDS
+int g_Container_count = 0;				/* number of Ordered_containers currently allocated */
+int g_Container_items_in_use = 0;		/* number of Ordered_container items currently in use */
+int g_Container_items_allocated = 0;	/* number of Ordered_container items currently allocated */
+int g_Container_promotions = 0;			/* number of times an Ordered_container has become a tree */
+int g_Container_demotions = 0;			/* number of times an Ordered_container has become an array */
+#endif
+
+/*
+Private helper functions declarations
+*/
+
+/* Initialize the container to an empty array */
+static void OC_initialize_container(struct Ordered_container* c_ptr);
+
+/* Deallocate the array or all the nodes of the tree */
+static void OC_deallocate_all(struct Ordered_container* c_ptr);
+
+/* Deallocate a node and all the nodes below it */
+static void OC_deallocate_nodes(struct Node* node_ptr);
+
+/* Count an insertion or deletion, and change the representation if it no longer suits the container */
+static void OC_adapt(struct Ordered_container* c_ptr);
+
+/* Halve the counts of recent operations once they cover more than twice the size of the container */
+static void OC_age_counts(struct Ordered_container* c_ptr);
+
+/* Change the container from an array into a tree */
+static void OC_promote(struct Ordered_container* c_ptr);
+
+/* Change the container from a tree into an array */
+static void OC_demote(struct Ordered_container* c_ptr);
+
+/* Build a balanced tree of the data pointers in the range [left, right) of the array */
+static struct Node* OC_build_tree(void** cells, int left, int right, struct Node* parent);
+
+/* Make the array big enough for the given number of cells */
+static void OC_reserve_cells(struct Ordered_container* c_ptr, int count);
+
+/* Return the height of a node, zero for none */
+static int OC_height(const struct Node* node_ptr);
+
+/* Set the height of a node from the heights of its children */
+static void OC_update_height(struct Node* node_ptr);
+
+/* Put the new node in the place of the old one under the parent, or at the root if there is no parent */
+static void OC_replace_child(struct Ordered_container* c_ptr, struct Node* parent, struct Node* old_node, struct Node* new_node);
+
+/* Rotate the subtree left or right, and return its new top node */
+static struct Node* OC_rotate_left(struct Ordered_container* c_ptr, struct Node* node_ptr);
+static struct Node* OC_rotate_right(struct Ordered_container* c_ptr, struct Node* node_ptr);
+
+/* Restore the heights and balance of the nodes from this node up to the root */
+static void OC_rebalance(struct Ordered_container* c_ptr, struct Node* node_ptr);
+
+/* Return the first node of the tree in order, or the node after this one */
+static struct Node* OC_first_node(struct Node* node_ptr);
+static struct Node* OC_next_node(struct Node* node_ptr);
+
+/* Type of function used to pass function pointers around OC_apply functions */
+typedef void(*OC_apply_template_fp_t) (void);
+
+/* Helper function for OC_apply functions */
+static int OC_apply_helper(const struct Ordered_container* c_ptr, OC_apply_template_fp_t afp, void* arg_ptr, apply_enum apply_func);
+
+/*
+Functions for the entire container.
+*/
+
+/* Create an empty container using the supplied comparison function, and return the pointer to it. */
+struct Ordered_container* OC_create_container(OC_comp_fp_t f_ptr)
+{
+	struct Ordered_container *c_ptr = malloc(sizeof(struct Ordered_container));
+	OC_SET_OPS(c_ptr, OC_adaptive_ops);
+	c_ptr->comp_fun = f_ptr;
+	OC_initialize_container(c_ptr);
+	g_Container_count++;
+	return c_ptr;
+}
+
+/* Create an empty lazy container using the supplied comparison function, and return the pointer to it.
+A container that is inserted into often becomes a tree, so a lazy container is the same as any other. */
+struct Ordered_container* OC_create_lazy_container(OC_comp_fp_t f_ptr)
+{
+	return OC_create_container(f_ptr);
+}
+
+/* Destroy the container and its items; caller is responsible for
+deleting all pointed-to data before calling this function.
+After this call, the container pointer value must not be used again. */
+void OC_destroy_container(struct Ordered_container* c_ptr)
+{
+	OC_deallocate_all(c_ptr);
+	free(c_ptr);
+	g_Container_count--;
+}
+
+/* Delete all the items in the container and initialize it.
+Caller is responsible for deleting any pointed-to data first. */
+void OC_clear(struct Ordered_container* c_ptr)
+{
+	OC_deallocate_all(c_ptr);
+	OC_initialize_container(c_ptr);
+}
+
+/* Return the number of items currently stored in the container */
+int OC_get_size(const struct Ordered_container* c_ptr)
+{
+	return c_ptr->size;
+}
+
+/* Return non-zero (true) if the container is empty, zero (false) if the container is non-empty */
+int OC_empty(const struct Ordered_container* c_ptr)
+{
+	return c_ptr->size == 0;
+}
+
+/* Set how the container allocates memory for its items; this implementation ignores it,
+since a large container that is changed often becomes a tree instead. */
+void OC_set_allocation_policy(struct Ordered_container* c_ptr, const struct OC_allocation_policy* policy_ptr)
+{
+}
+
+/*
+Functions for working with individual items in the container.
+*/
+
+/* Get the data object pointer from an item. */
+void* OC_get_data_ptr(const void* item_ptr)
+{
+	return *(void* const*)item_ptr;
+}
+
+/* Delete the specified item.
+Caller is responsible for any deletion of the data pointed to by the item. */
+void OC_delete_item(struct Ordered_container* c_ptr, void* item_ptr)
+{
+	if (c_ptr->cells)
+	{
+		void **cell = (void**)item_ptr;
+		memmove(cell, cell + 1, (c_ptr->cells + c_ptr->size - cell - 1) * sizeof(void *));
+	}
+	else
+	{
+		struct Node *node = (struct Node*)item_ptr;
+		struct Node *child;
+		/* a node with two children takes the data of the next node, which is deleted instead */
+		if (node->left && node->right)
+		{
+			struct Node *next = OC_first_node(node->right);
+			node->data_ptr = next->data_ptr;
+			node = next;
+		}
+		child = node->left ? node->left : node->right;
+		if (child)
+		{
+			child->parent = node->parent;
+		}
+		OC_replace_child(c_ptr, node->parent, node, child);
+		OC_rebalance(c_ptr, node->parent);
+		free(node);
+		g_Container_items_allocated--;
+	}
+	c_ptr->size--;
+	g_Container_items_in_use--;
+	OC_adapt(c_ptr);
+}
+
+/*
+Functions that search and insert into the container using the supplied comparison function.
+*/
+
+/* Create a new item for the specified data pointer and put it in the container in order.
+If there is already an item in the container that compares equal to new item according to
+the comparison function, the order of the new item relative to the existing item is not specified.
+This function will not modify the pointed-to data. */
+void OC_insert(struct Ordered_container* c_ptr, const void* data_ptr)
+{
+	if (c_ptr->cells)
+	{
+		int left = 0;
+		int right = c_ptr->size;
+		OC_reserve_cells(c_ptr, c_ptr->size + 1);
+		/* find the position after the items that do not come after the new one */
+		while (left < right)
+		{
+			int middle = (left + right) / 2;
+			if (c_ptr->comp_fun(data_ptr, c_ptr->cells[middle]) < 0)
+			{
+				right = middle;
+			}
+			else
+			{
+				left = middle + 1;
+			}
+		}
+		memmove(c_ptr->cells + left + 1, c_ptr->cells + left, (c_ptr->size - left) * sizeof(void *));
+		c_ptr->cells[left] = (void*)data_ptr;
+	}
+	else
+	{
+		struct Node *new_node = malloc(sizeof(struct Node));
+		struct Node *parent = NULL;
+		struct Node **link = &c_ptr->root;
+		while (*link)
+		{
+			parent = *link;
+			link = c_ptr->comp_fun(data_ptr, parent->data_ptr) < 0 ? &parent->left : &parent->right;
+		}
+		new_node->data_ptr = (void*)data_ptr;
+		new_node->left = NULL;
+		new_node->right = NULL;
+		new_node->parent = parent;
+		new_node->height = 1;
+		*link = new_node;
+		OC_rebalance(c_ptr, parent);
+		g_Container_items_allocated++;
+	}
+	c_ptr->size++;
+	g_Container_items_in_use++;
+	OC_adapt(c_ptr);
+}
+
+/* Return a pointer to an item that points to data equal to the data object pointed to by data_ptr,
+using the ordering function to do the comparison with data_ptr as the first argument.
+The data_ptr object is assumed to be of the same type as the data objects pointed to by container items.
+NULL is returned if no matching item is found. If more than one matching item is present, it is
+unspecified which one is returned. The pointed-to data will not be modified. */
+void* OC_find_item(const struct Ordered_container* c_ptr, const void* data_ptr)
+{
+	return OC_find_item_arg(c_ptr, data_ptr, c_ptr->comp_fun);
+}
+
+/* Return a pointer to the item that points to data that matches the supplied argument given by arg_ptr
+according to the supplied function, which compares arg_ptr as the first argument with the data pointer
+in each item. This function does not require that arg_ptr be of the same type as the data objects, and
+so allows the container to be searched without creating a complete data object first.
+NULL is returned if no matching item is found. If more than one matching item is present, it is
+unspecified which one is returned. The comparison function must implement an ordering consistent
+with the ordering produced by the comparison function specified when the container was created;
+if not, the result is undefined. */
+void* OC_find_item_arg(const struct Ordered_container* c_ptr, const void* arg_ptr, OC_find_item_arg_fp_t fafp)
+{
+	/* only the count is changed; the representation is changed by insertions and deletions */
+	COUNT_FIND(c_ptr);
+	if (c_ptr->cells)
+	{
+		int left = 0;
+		int right = c_ptr->size - 1;
+		while (left <= right)
+		{
+			int middle = (left + right) / 2;
+			int comp_result = fafp(arg_ptr, c_ptr->cells[middle]);
+			if (comp_result < 0)
+			{
+				right = middle - 1;
+			}
+			else if (comp_result > 0)
+			{
+				left = middle + 1;
+			}
+			else
+			{
+				return c_ptr->cells + middle;
+			}
+		}
+	}
+	else
+	{
+		struct Node *node = c_ptr->root;
+		while (node)
+		{
+			int comp_result = fafp(arg_ptr, node->data_ptr);
+			if (comp_result == 0)
+			{
+				return node;
+			}
+			node = comp_result < 0 ? node->left : node->right;
+		}
+	}
+	return NULL;
+}
+
+/* Functions that traverse the items in the container, processing each item in order. */
+
+/* Apply the supplied function to the data pointer in each item of the container.
+The contents of the container cannot be modified. */
+void OC_apply(const struct Ordered_container* c_ptr, OC_apply_fp_t afp)
+{
+	OC_apply_helper(c_ptr, (OC_apply_template_fp_t)afp, NULL, APPLY);
+}
+
+/* Apply the supplied function to the data pointer in each item in the container.
+If the function returns non-zero, the iteration is terminated, and that value
+returned. Otherwise, zero is returned. The contents of the container cannot be modified. */
+int OC_apply_if(const struct Ordered_container* c_ptr, OC_apply_if_fp_t afp)
+{
+	return OC_apply_helper(c_ptr, (OC_apply_template_fp_t)afp, NULL, APPLY_IF);
+}
+
+/* Apply the supplied function to the data pointer in each item in the container;
+the function takes a second argument, which is the supplied void pointer.
+The contents of the container cannot be modified. */
+void OC_apply_arg(const struct Ordered_container* c_ptr, OC_apply_arg_fp_t afp, void* arg_ptr)
+{
+	OC_apply_helper(c_ptr, (OC_apply_template_fp_t)afp, arg_ptr, APPLY_ARG);
+}
+
+/* Apply the supplied function to the data pointer in each item in the container;
+the function takes a second argument, which is the supplied void pointer.
+If the function returns non-zero, the iteration is terminated, and that value
+returned. Otherwise, zero is returned. The contents of the container cannot be modified */
+int OC_apply_if_arg(const struct Ordered_container* c_ptr, OC_apply_if_arg_fp_t afp, void* arg_ptr)
+{
+	return OC_apply_helper(c_ptr, (OC_apply_template_fp_t)afp, arg_ptr, APPLY_ARG_IF);
+}
+
+/* Remove every item for whose data pointer the supplied function returns non-zero, and return
+the number of items removed; the function takes a second argument, which is the supplied void pointer. */
+int OC_remove_if(struct Ordered_container* c_ptr, OC_apply_if_arg_fp_t afp, void* arg_ptr)
+{
+	int kept = 0;
+	int removed, i;
+	if (c_ptr->cells)
+	{
+		for (i = 0; i < c_ptr->size; i++)
+		{
+			if (!afp(c_ptr->cells[i], arg_ptr))
+			{
+				c_ptr->cells[kept++] = c_ptr->cells[i];
+			}
+		}
+	}
+	else
+	{
+		/* the tree is rebuilt from the data pointers that are kept, in order */
+		void **cells = malloc((c_ptr->size > 0 ? c_ptr->size : 1) * sizeof(void *));
+		struct Node *node;
+		for (node = OC_first_node(c_ptr->root); node; node = OC_next_node(node))
+		{
+			if (!afp(node->data_ptr, arg_ptr))
+			{
+				cells[kept++] = node->data_ptr;
+			}
+		}
+		OC_deallocate_nodes(c_ptr->root);
+		c_ptr->root = OC_build_tree(cells, 0, kept, NULL);
+		free(cells);
+		g_Container_items_allocated -= c_ptr->size - kept;
+	}
+	removed = c_ptr->size - kept;
+	c_ptr->size = kept;
+	g_Container_items_in_use -= removed;
+	OC_adapt(c_ptr);
+	return removed;
+}
+
+/*
+Private helper functions
+*/
+
+/* Initialize the container to an empty array */
+static void OC_initialize_container(struct Ordered_container* c_ptr)
+{
+	c_ptr->cells = c_ptr->inline_cells;
+	c_ptr->allocation = INLINE_CAPACITY;
+	c_ptr->root = NULL;
+	c_ptr->size = 0;
+	c_ptr->changes = 0;
+	c_ptr->finds = 0;
+	g_Container_items_allocated += INLINE_CAPACITY;
+}
+
+/* Deallocate the array or all the nodes of the tree */
+static void OC_deallocate_all(struct Ordered_container* c_ptr)
+{
+	if (c_ptr->cells)
+	{
+		if (c_ptr->cells != c_ptr->inline_cells)
+		{
+			free(c_ptr->cells);
+		}
+		g_Container_items_allocated -= c_ptr->allocation;
+	}
+	else
+	{
+		OC_deallocate_nodes(c_ptr->root);
+		g_Container_items_allocated -= c_ptr->size;
+	}
+	g_Container_items_in_use -= c_ptr->size;
+}
+
+/* Deallocate a node and all the nodes below it */
+static void OC_deallocate_nodes(struct Node* node_ptr)
+{
+	while (node_ptr)
+	{
+		struct Node *right = node_ptr->right;
+		OC_deallocate_nodes(node_ptr->left);
+		free(node_ptr);
+		node_ptr = right;
+	}
+}
+
+/* Count an insertion or deletion, and change the representation if it no longer suits the container */
+static void OC_adapt(struct Ordered_container* c_ptr)
+{
+	c_ptr->changes++;
+	OC_age_counts(c_ptr);
+	/* a change costs an array about size / PROMOTE_SIZE times what a find costs a tree over an array,
+	and demotion needs the finds to win by twice as much so that the container does not switch back and forth */
+	if (c_ptr->cells)
+	{
+		if (c_ptr->size > PROMOTE_SIZE && (double)c_ptr->changes * c_ptr->size > (double)c_ptr->finds * PROMOTE_SIZE)
+		{
+			OC_promote(c_ptr);
+		}
+	}
+	else if (c_ptr->size < DEMOTE_SIZE || (c_ptr->changes + c_ptr->finds >= c_ptr->size
+		&& (double)c_ptr->changes * c_ptr->size * 2 < (double)c_ptr->finds * PROMOTE_SIZE))
+	{
+		OC_demote(c_ptr);
+	}
+}
+
+/* Halve the counts of recent operations once they cover more than twice the size of the container */
+static void OC_age_counts(struct Ordered_container* c_ptr)
+{
+	int window = c_ptr->size > PROMOTE_SIZE ? c_ptr->size : PROMOTE_SIZE;
+	if (c_ptr->changes + c_ptr->finds > 2 * window)
+	{
+		c_ptr->changes /= 2;
+		c_ptr->finds /= 2;
+	}
+}
+
+/* Change the container from an array into a tree */
+static void OC_promote(struct Ordered_container* c_ptr)
+{
+	c_ptr->root = OC_build_tree(c_ptr->cells, 0, c_ptr->size, NULL);
+	if (c_ptr->cells != c_ptr->inline_cells)
+	{
+		free(c_ptr->cells);
+	}
+	g_Container_items_allocated += c_ptr->size - c_ptr->allocation;
+	c_ptr->cells = NULL;
+	c_ptr->allocation = 0;
+	c_ptr->changes = 0;
+	c_ptr->finds = 0;
+	g_Container_promotions++;
+}
+
+/* Change the container from a tree into an array */
+static void OC_demote(struct Ordered_container* c_ptr)
+{
+	struct Node *node;
+	int i = 0;
+	c_ptr->cells = c_ptr->inline_cells;
+	c_ptr->allocation = INLINE_CAPACITY;
+	while (c_ptr->allocation < c_ptr->size)
+	{
+		c_ptr->allocation *= 2;
+	}
+	if (c_ptr->allocation > INLINE_CAPACITY)
+	{
+		c_ptr->cells = malloc(c_ptr->allocation * sizeof(void *));
+	}
+	g_Container_items_allocated += c_ptr->allocation - c_ptr->size;
+	for (node = OC_first_node(c_ptr->root); node; node = OC_next_node(node))
+	{
+		c_ptr->cells[i++] = node->data_ptr;
+	}
+	OC_deallocate_nodes(c_ptr->root);
+	c_ptr->root = NULL;
+	c_ptr->changes = 0;
+	c_ptr->finds = 0;
+	g_Container_demotions++;
+}
+
+/* Build a balanced tree of the data pointers in the range [left, right) of the array */
+static struct Node* OC_build_tree(void** cells, int left, int right, struct Node* parent)
+{
+	struct Node *node;
+	int middle;
+	if (left >= right)
+	{
+		return NULL;
+	}
+	middle = (left + right) / 2;
+	node = malloc(sizeof(struct Node));
+	node->data_ptr = cells[middle];
+	node->parent = parent;
+	node->left = OC_build_tree(cells, left, middle, node);
+	node->right = OC_build_tree(cells, middle + 1, right, node);
+	OC_update_height(node);
+	return node;
+}
+
+/* Make the array big enough for the given number of cells */
+static void OC_reserve_cells(struct Ordered_container* c_ptr, int count)
+{
+	int new_allocation = c_ptr->allocation;
+	void **new_cells;
+	if (count <= c_ptr->allocation)
+	{
+		return;
+	}
+	while (new_allocation < count)
+	{
+		new_allocation *= 2;
+	}
+	new_cells = malloc(new_allocation * sizeof(void *));
+	memcpy(new_cells, c_ptr->cells, c_ptr->size * sizeof(void *));
+	if (c_ptr->cells != c_ptr->inline_cells)
+	{
+		free(c_ptr->cells);
+	}
+	g_Container_items_allocated += new_allocation - c_ptr->allocation;
+	c_ptr->cells = new_cells;
+	c_ptr->allocation = new_allocation;
+}
+
+/* Return the height of a node, zero for none */
+static int OC_height(const struct Node* node_ptr)
+{
+	return node_ptr ? node_ptr->height : 0;
+}
+
+/* Set the height of a node from the heights of its children */
+static void OC_update_height(struct Node* node_ptr)
+{
+	int left = OC_height(node_ptr->left);
+	int right = OC_height(node_ptr->right);
+	node_ptr->height = (left > right ? left : right) + 1;
+}
+
+/* Put the new node in the place of the old one under the parent, or at the root if there is no parent */
+static void OC_replace_child(struct Ordered_container* c_ptr, struct Node* parent, struct Node* old_node, struct Node* new_node)
+{
+	if (!parent)
+	{
+		c_ptr->root = new_node;
+	}
+	else if (parent->left == old_node)
+	{
+		parent->left = new_node;
+	}
+	else
+	{
+		parent->right = new_node;
+	}
+}
+
+/* Rotate the subtree left or right, and return its new top node */
+static struct Node* OC_rotate_left(struct Ordered_container* c_ptr, struct Node* node_ptr)
+{
+	struct Node *top = node_ptr->right;
+	node_ptr->right = top->left;
+	if (top->left)
+	{
+		top->left->parent = node_ptr;
+	}
+	top->parent = node_ptr->parent;
+	OC_replace_child(c_ptr, node_ptr->parent, node_ptr, top);
+	top->left = node_ptr;
+	node_ptr->parent = top;
+	OC_update_height(node_ptr);
+	OC_update_height(top);
+	return top;
+}
+
+static struct Node* OC_rotate_right(struct Ordered_container* c_ptr, struct Node* node_ptr)
+{
+	struct Node *top = node_ptr->left;
+	node_ptr->left = top->right;
+	if (top->right)
+	{
+		top->right->parent = node_ptr;
+	}
+	top->parent = node_ptr->parent;
+	OC_replace_child(c_ptr, node_ptr->parent, node_ptr, top);
+	top->right = node_ptr;
+	node_ptr->parent = top;
+	OC_update_height(node_ptr);
+	OC_update_height(top);
+	return top;
+}
+
+/* Restore the heights and balance of the nodes from this node up to the root */
+static void OC_rebalance(struct Ordered_container* c_ptr, struct Node* node_ptr)
+{
+	while (node_ptr)
+	{
+		int balance;
+		OC_update_height(node_ptr);
+		balance = OC_height(node_ptr->left) - OC_height(node_ptr->right);
+		if (balance > 1)
+		{
+			if (OC_height(node_ptr->left->left) < OC_height(node_ptr->left->right))
+			{
+				OC_rotate_left(c_ptr, node_ptr->left);
+			}
+			node_ptr = OC_rotate_right(c_ptr, node_ptr);
+		}
+		else if (balance < -1)
+		{
+			if (OC_height(node_ptr->right->right) < OC_height(node_ptr->right->left))
+			{
+				OC_rotate_right(c_ptr, node_ptr->right);
+			}
+			node_ptr = OC_rotate_left(c_ptr, node_ptr);
+		}
+		node_ptr = node_ptr->parent;
+	}
+}
+
+/* Return the first node of the tree in order, or the node after this one */
+static struct Node* OC_first_node(struct Node* node_ptr)
+{
+	if (node_ptr)
+	{
+		while (node_ptr->left)
+		{
+			node_ptr = node_ptr->left;
+		}
+	}
+	return node_ptr;
+}
+
+static struct Node* OC_next_node(struct Node* node_ptr)
+{
+	if (node_ptr->right)
+	{
+		return OC_first_node(node_ptr->right);
+	}
+	while (node_ptr->parent && node_ptr->parent->right == node_ptr)
+	{
+		node_ptr = node_ptr->parent;
+	}
+	return node_ptr->parent;
+}
+
+/* Helper function for OC_apply functions */
+static int OC_apply_helper(const struct Ordered_container* c_ptr, OC_apply_template_fp_t afp, void* arg_ptr, apply_enum apply_func)
+{
+	struct Node *node = c_ptr->cells ? NULL : OC_first_node(c_ptr->root);
+	int function_return = 0;
+	int i;
+	for (i = 0; i < c_ptr->size; i++)
+	{
+		void *data_ptr;
+		if (c_ptr->cells)
+		{
+			data_ptr = c_ptr->cells[i];
+		}
+		else
+		{
+			data_ptr = node->data_ptr;
+			node = OC_next_node(node);
+		}
+		switch (apply_func)
+		{
+		case APPLY:
+			((OC_apply_fp_t)afp)(data_ptr);
+			break;
+		case APPLY_IF:
+			function_return = ((OC_apply_if_fp_t)afp)(data_ptr);
+			break;
+		case APPLY_ARG:
+			((OC_apply_arg_fp_t)afp)(data_ptr, arg_ptr);
+			break;
+		case APPLY_ARG_IF:
+			function_return = ((OC_apply_if_arg_fp_t)afp)(data_ptr, arg_ptr);
+			break;
+		}
+		if (function_return)
+		{
+			break;
+		}
+	}
+	return function_return;
+}
+
+#ifdef OC_RUNTIME_BACKENDS
+/* The table of this implementation's functions, for Ordered_container.c */
+OC_DEFINE_OPS(OC_adaptive_ops);
+#else
+/* Create an empty container using the supplied comparison function, and return the pointer to it.
+This is the only implementation linked into the program, so it is used whatever backend is asked for. */
+struct Ordered_container* OC_create_container_backend(OC_comp_fp_t f_ptr, enum OC_backend backend)
+{
+	return OC_create_container(f_ptr);
+}
+
+/* Create an empty lazy container using the supplied comparison function, and return the pointer to it.
+This is the only implementation linked into the program, so it is used whatever backend is asked for. */
+struct Ordered_container* OC_create_lazy_container_backend(OC_comp_fp_t f_ptr, enum OC_backend backend)
+{
+	return OC_create_lazy_container(f_ptr);
+}
+#endif
+
+#endif
@@ -1,23 +1,43 @@
 #ifndef ORDERED_CONTAINER_ARRAY
 #define ORDERED_CONTAINER_ARRAY
 
-#include "Ordered_container.h"
+/* for mremap, which moves a mapping to a new size without copying it */
+#define _GNU_SOURCE
+
+#define OC_BACKEND_PREFIX OC_array_
+#include "Ordered_container_backend.h"
 #include "Utility.h"
 #include "p1_globals.h"
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #define SIZE_FACTOR 2
 #define ALLOCATION_INCREASE 1
 #define INITIAL_ALLOCATION 3
+#define DEFAULT_LARGE_ALLOCATION 65536	/* items in the smallest array that is mapped */
+#define DEFAULT_SHRINK_DIVISOR 4
+#define LAZY_TAIL_LIMIT 32		/* longest tail that is searched without being merged */
 
-/* A complete type declaration for Ordered_container implemented as an array */
+/* A complete type declaration for Ordered_container implemented as an array.
+The first sorted_size items are in order; in a lazy container, the items after them
+are an unsorted tail in the order they were inserted. */
 struct Ordered_container {
+	OC_OPS_MEMBER
 	OC_comp_fp_t comp_fun;	/* pointer to comparison function  */
 	void** array;			/* pointer to array of pointers to void */
 	int allocation;			/* current size of array */
 	int size;				/* number of items  currently in the array */
+	int sorted_size;		/* number of items in order at the start of the array */
+	int lazy;				/* whether inserted items go in the tail */
+	size_t mapped_bytes;	/* size of the mapping that holds the array, or 0 if it is allocated with malloc */
+	struct OC_allocation_policy policy;
 };
 
+/* The policy of a container until it is given another */
+static const struct OC_allocation_policy default_policy = { DEFAULT_LARGE_ALLOCATION, 0, DEFAULT_SHRINK_DIVISOR };
+
 /* Enum for OC_apply functions */
 typedef enum { APPLY, APPLY_IF, APPLY_ARG, APPLY_ARG_IF, APPLY_INTERNAL
 } apply_enum;
@@ -29,9 +49,13 @@ struct Search_Result {
 };
 
 /* These global variables are used to monitor the memory usage of the Ordered_container */
+#ifndef OC_RUNTIME_BACKENDS
 int g_Container_count = 0;				/* number of Ordered_containers currently allocated */
 int g_Container_items_in_use = 0;		/* number of Ordered_container items currently in use */
 int g_Container_items_allocated = 0;	/* number of Ordered_container items currently allocated */
+int g_Container_promotions = 0;			/* never changed, since this implementation has only one representation */
+int g_Container_demotions = 0;			/* never changed */
+#endif
 
 /*
 Private helper functions declarations
@@ -49,6 +73,19 @@ static void OC_deallocate_all(struct Ordered_container* c_ptr);
 /* Reallocate array */
 static void OC_reallocate_array(struct Ordered_container* c_ptr);
 
+/* Change the number of items the array has room for, mapping it if it is large under the policy */
+static void OC_resize_array(struct Ordered_container* c_ptr, int new_allocation);
+
+/* Allocate the array for the given number of items with malloc, moving it out of its mapping if it is mapped */
+static void OC_allocate_array(struct Ordered_container* c_ptr, int new_allocation);
+
+/* Map or remap the array for the given number of items; returns non-zero,
+leaving the array as it was, if the mapping could not be made */
+static int OC_map_array(struct Ordered_container* c_ptr, int new_allocation);
+
+/* Halve a mapped array as often as the policy calls for after deletions */
+static void OC_shrink_array(struct Ordered_container* c_ptr);
+
 /* Grabs the data ptr from the item directly preceding this item*/
 static int OC_take_value_from_left(struct Ordered_container* c_ptr, int i);
 
@@ -68,6 +105,12 @@ static int OC_apply_helper(const struct Ordered_container* c_ptr, OC_apply_templ
 /* Simplified call to OC_apply_helper */
 static int OC_apply_helper_simple(const struct Ordered_container* c_ptr, OC_apply_template_fp_t afp, void* arg_ptr, apply_enum apply_func);
 
+/* Sort the tail of a lazy container and merge it into the items in order */
+static void OC_merge_tail(struct Ordered_container* c_ptr);
+
+/* Merge two runs of items in order into the destination */
+static void OC_merge_runs(OC_comp_fp_t comp_fun, void** first, int first_size, void** second, int second_size, void** destination);
+
 /*
 Functions for the entire container.
 */
@@ -76,12 +119,23 @@ Functions for the entire container.
 struct Ordered_container* OC_create_container(OC_comp_fp_t f_ptr)
 {
 	struct Ordered_container *c_ptr = malloc(sizeof(struct Ordered_container));
+	OC_SET_OPS(c_ptr, OC_array_ops);
 	c_ptr->comp_fun = f_ptr;
+	c_ptr->lazy = 0;
+	c_ptr->policy = default_policy;
 	OC_initialize_container(c_ptr);
 	g_Container_count++;
 	return c_ptr;
 }
 
+/* Create an empty lazy container using the supplied comparison function, and return the pointer to it. */
+struct Ordered_container* OC_create_lazy_container(OC_comp_fp_t f_ptr)
+{
+	struct Ordered_container *c_ptr = OC_create_container(f_ptr);
+	c_ptr->lazy = 1;
+	return c_ptr;
+}
+
 /* Destroy the container and its items; caller is responsible for
 deleting all pointed-to data before calling this function.
 After this call, the container pointer value must not be used again. */
@@ -112,6 +166,13 @@ int OC_empty(const struct Ordered_container* c_ptr)
 	return c_ptr->size == 0;
 }
 
+/* Set how the container allocates memory for its items; the policy takes effect when the
+container next allocates. */
+void OC_set_allocation_policy(struct Ordered_container* c_ptr, const struct OC_allocation_policy* policy_ptr)
+{
+	c_ptr->policy = *policy_ptr;
+}
+
 /*
 Functions for working with individual items in the container.
 */
@@ -126,9 +187,16 @@ void* OC_get_data_ptr(const void* item_ptr)
 Caller is responsible for any deletion of the data pointed to by the item. */
 void OC_delete_item(struct Ordered_container* c_ptr, void* item_ptr)
 {
-	OC_apply_helper(c_ptr, (OC_apply_template_fp_t)OC_take_value_from_right, NULL, APPLY_INTERNAL, (void **)item_ptr - c_ptr->array, c_ptr->size - 1, 0);
+	int index = (void **)item_ptr - c_ptr->array;
+	/* the items after it move down one, so the tail stays after the items in order */
+	OC_apply_helper(c_ptr, (OC_apply_template_fp_t)OC_take_value_from_right, NULL, APPLY_INTERNAL, index, c_ptr->size - 1, 0);
+	if (index < c_ptr->sorted_size)
+	{
+		c_ptr->sorted_size--;
+	}
 	c_ptr->size--;
 	g_Container_items_in_use--;
+	OC_shrink_array(c_ptr);
 }
 
 /*
@@ -141,12 +209,34 @@ the comparison function, the order of the new item relative to the existing item
 This function will not modify the pointed-to data. */
 void OC_insert(struct Ordered_container* c_ptr, const void* data_ptr)
 {
-	struct Search_Result result = OC_binary_search(c_ptr, data_ptr, c_ptr->comp_fun);
+	struct Search_Result result;
+	int in_order = c_ptr->size == c_ptr->sorted_size;
+	if (c_ptr->size == 0 || (in_order && c_ptr->comp_fun(data_ptr, c_ptr->array[c_ptr->size - 1]) >= 0))
+	{
+		/* inserting in order (e.g. when restoring) goes at the end without a search */
+		result.found = 0;
+		result.index = c_ptr->size;
+	}
+	else if (c_ptr->lazy)
+	{
+		/* anything else in a lazy container goes at the end of the tail */
+		result.found = 0;
+		result.index = c_ptr->size;
+		in_order = 0;
+	}
+	else
+	{
+		result = OC_binary_search(c_ptr, data_ptr, c_ptr->comp_fun);
+	}
 	if (c_ptr->size == c_ptr->allocation)
 	{
 		OC_reallocate_array(c_ptr);
 	}
 	c_ptr->size++;
+	if (in_order)
+	{
+		c_ptr->sorted_size++;
+	}
 	OC_apply_helper(c_ptr, (OC_apply_template_fp_t)OC_take_value_from_left, NULL, APPLY_INTERNAL, result.index + 1, c_ptr->size, 1);
 	c_ptr->array[result.index] = (void*)data_ptr;
 	g_Container_items_in_use++;
@@ -172,15 +262,26 @@ with the ordering produced by the comparison function specified when the contain
 if not, the result is undefined. */
 void* OC_find_item_arg(const struct Ordered_container* c_ptr, const void* arg_ptr, OC_find_item_arg_fp_t fafp)
 {
-	struct Search_Result result = OC_binary_search(c_ptr, arg_ptr, fafp);
+	struct Search_Result result;
+	int i;
+	if (c_ptr->size - c_ptr->sorted_size > LAZY_TAIL_LIMIT)
+	{
+		OC_merge_tail((struct Ordered_container *)c_ptr);
+	}
+	result = OC_binary_search(c_ptr, arg_ptr, fafp);
 	if (result.found)
 	{
 		return c_ptr->array + result.index;
 	}
-	else
+	/* a short tail is checked item by item */
+	for (i = c_ptr->sorted_size; i < c_ptr->size; i++)
 	{
-		return NULL;
+		if (fafp(arg_ptr, c_ptr->array[i]) == 0)
+		{
+			return c_ptr->array + i;
+		}
 	}
+	return NULL;
 }
 
 /* Functions that traverse the items in the container, processing each item in order. */
@@ -217,6 +318,33 @@ int OC_apply_if_arg(const struct Ordered_container* c_ptr, OC_apply_if_arg_fp_t
 	return OC_apply_helper_simple(c_ptr, (OC_apply_template_fp_t)afp, arg_ptr, APPLY_ARG_IF);
 }
 
+/* Remove every item for whose data pointer the supplied function returns non-zero, and return
+the number of items removed; the function takes a second argument, which is the supplied void pointer. */
+int OC_remove_if(struct Ordered_container* c_ptr, OC_apply_if_arg_fp_t afp, void* arg_ptr)
+{
+	int kept = 0;
+	int kept_sorted = 0;
+	int removed, i;
+	/* each item that is kept is moved straight to its final place */
+	for (i = 0; i < c_ptr->size; i++)
+	{
+		if (!afp(c_ptr->array[i], arg_ptr))
+		{
+			c_ptr->array[kept++] = c_ptr->array[i];
+			if (i < c_ptr->sorted_size)
+			{
+				kept_sorted++;
+			}
+		}
+	}
+	removed = c_ptr->size - kept;
+	c_ptr->size = kept;
+	c_ptr->sorted_size = kept_sorted;
+	g_Container_items_in_use -= removed;
+	OC_shrink_array(c_ptr);
+	return removed;
+}
+
 /*
 Private helper functions
 */
@@ -226,7 +354,7 @@ static struct Search_Result OC_binary_search(const struct Ordered_container* c_p
 {
 	struct Search_Result result;
 	int left = 0;
-	int right = c_ptr->size - 1;
+	int right = c_ptr->sorted_size - 1;
 	int middle = 0;
 	int comparison;
 	result.found = 0;
@@ -261,6 +389,8 @@ static void OC_initialize_container(struct Ordered_container* c_ptr)
 	c_ptr->allocation = INITIAL_ALLOCATION;
 	g_Container_items_allocated += c_ptr->allocation;
 	c_ptr->size = 0;
+	c_ptr->sorted_size = 0;
+	c_ptr->mapped_bytes = 0;
 	c_ptr->array = calloc(c_ptr->allocation, sizeof(void**));
 }
 
@@ -269,23 +399,120 @@ static void OC_deallocate_all(struct Ordered_container* c_ptr)
 {
 	g_Container_items_in_use -= c_ptr->size;
 	g_Container_items_allocated -= c_ptr->allocation;
-	free(c_ptr->array);
+	if (c_ptr->mapped_bytes)
+	{
+		munmap(c_ptr->array, c_ptr->mapped_bytes);
+	}
+	else
+	{
+		free(c_ptr->array);
+	}
 }
 
 /* Reallocate array */
 static void OC_reallocate_array(struct Ordered_container* c_ptr)
 {
-	void** old_array = c_ptr->array;
-	int i;
-	int new_allocation = (c_ptr->allocation + ALLOCATION_INCREASE) * SIZE_FACTOR;
+	OC_resize_array(c_ptr, (c_ptr->allocation + ALLOCATION_INCREASE) * SIZE_FACTOR);
+}
+
+/* Change the number of items the array has room for, mapping it if it is large under the policy */
+static void OC_resize_array(struct Ordered_container* c_ptr, int new_allocation)
+{
 	g_Container_items_allocated += new_allocation - c_ptr->allocation;
+	/* an array that cannot be mapped is allocated with malloc instead */
+	if (c_ptr->policy.large_allocation <= 0 || new_allocation < c_ptr->policy.large_allocation
+		|| OC_map_array(c_ptr, new_allocation))
+	{
+		OC_allocate_array(c_ptr, new_allocation);
+	}
 	c_ptr->allocation = new_allocation;
-	c_ptr->array = calloc(c_ptr->allocation, sizeof(void**));
-	for (i = 0; i < c_ptr->size; i++)
+}
+
+/* Allocate the array for the given number of items with malloc, moving it out of its mapping if it is mapped */
+static void OC_allocate_array(struct Ordered_container* c_ptr, int new_allocation)
+{
+	if (c_ptr->mapped_bytes)
 	{
-		c_ptr->array[i] = old_array[i];
+		void **array = malloc(new_allocation * sizeof(void*));
+		memcpy(array, c_ptr->array, c_ptr->size * sizeof(void*));
+		munmap(c_ptr->array, c_ptr->mapped_bytes);
+		c_ptr->mapped_bytes = 0;
+		c_ptr->array = array;
+	}
+	else
+	{
+		/* realloc can often grow the block where it is instead of copying it */
+		c_ptr->array = realloc(c_ptr->array, new_allocation * sizeof(void*));
+	}
+}
+
+/* Map or remap the array for the given number of items; returns non-zero,
+leaving the array as it was, if the mapping could not be made */
+static int OC_map_array(struct Ordered_container* c_ptr, int new_allocation)
+{
+	size_t page_size = sysconf(_SC_PAGESIZE);
+	size_t bytes = (new_allocation * sizeof(void*) + page_size - 1) / page_size * page_size;
+	void *mapping;
+	if (bytes == c_ptr->mapped_bytes)
+	{
+		return 0;
+	}
+#ifdef MREMAP_MAYMOVE
+	if (c_ptr->mapped_bytes)
+	{
+		/* the pages are moved to the new addresses, not copied; on failure the old mapping is kept */
+		mapping = mremap(c_ptr->array, c_ptr->mapped_bytes, bytes, MREMAP_MAYMOVE);
+		if (mapping == MAP_FAILED)
+		{
+			return 1;
+		}
+	}
+	else
+#endif
+	{
+		mapping = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mapping == MAP_FAILED)
+		{
+			return 1;
+		}
+		memcpy(mapping, c_ptr->array, c_ptr->size * sizeof(void*));
+		if (c_ptr->mapped_bytes)
+		{
+			munmap(c_ptr->array, c_ptr->mapped_bytes);
+		}
+		else
+		{
+			free(c_ptr->array);
+		}
+	}
+#ifdef MADV_HUGEPAGE
+	if (c_ptr->policy.huge_pages)
+	{
+		madvise(mapping, bytes, MADV_HUGEPAGE);
+	}
+#endif
+	c_ptr->array = mapping;
+	c_ptr->mapped_bytes = bytes;
+	return 0;
+}
+
+/* Halve a mapped array as often as the policy calls for after deletions */
+static void OC_shrink_array(struct Ordered_container* c_ptr)
+{
+	int new_allocation = c_ptr->allocation;
+	if (!c_ptr->mapped_bytes || c_ptr->policy.shrink_divisor <= 0)
+	{
+		return;
+	}
+	/* a mapped array gives memory back to the system after many deletions */
+	while (c_ptr->size < new_allocation / c_ptr->policy.shrink_divisor)
+	{
+		new_allocation /= 2;
+	}
+	if (new_allocation != c_ptr->allocation)
+	{
+		OC_resize_array(c_ptr, new_allocation);
 	}
-	free(old_array);
 }
 
 /* Grabs the data ptr from the item directly preceding this item*/
@@ -344,7 +571,116 @@ static int OC_apply_helper(const struct Ordered_container* c_ptr, OC_apply_templ
 /* Simplified call to OC_apply_helper */
 static int OC_apply_helper_simple(const struct Ordered_container* c_ptr, OC_apply_template_fp_t afp, void* arg_ptr, apply_enum apply_func)
 {
+	if (c_ptr->sorted_size < c_ptr->size)
+	{
+		OC_merge_tail((struct Ordered_container *)c_ptr);
+	}
 	return OC_apply_helper(c_ptr, afp, arg_ptr, apply_func, 0, c_ptr->size, 0);
 }
 
+/* Sort the tail of a lazy container and merge it into the items in order */
+static void OC_merge_tail(struct Ordered_container* c_ptr)
+{
+	void **tail = c_ptr->array + c_ptr->sorted_size;
+	int tail_size = c_ptr->size - c_ptr->sorted_size;
+	void **buffer = malloc(tail_size * sizeof(void*));
+	void **source = tail;
+	void **destination = buffer;
+	int width, i, end, next;
+	/* merge runs of the tail of doubling width, back and forth between it and the buffer */
+	for (width = 1; width < tail_size; width *= 2)
+	{
+		void **swap;
+		for (i = 0; i < tail_size; i += 2 * width)
+		{
+			int first_size = (tail_size - i < width) ? tail_size - i : width;
+			int second_size = (tail_size - i - first_size < width) ? tail_size - i - first_size : width;
+			OC_merge_runs(c_ptr->comp_fun, source + i, first_size, source + i + first_size, second_size, destination + i);
+		}
+		swap = source;
+		source = destination;
+		destination = swap;
+	}
+	if (source != buffer)
+	{
+		for (i = 0; i < tail_size; i++)
+		{
+			buffer[i] = source[i];
+		}
+	}
+	/* working down from the largest, each tail item is put after the items in order that come
+	after it, which are found with a binary search; the tail is usually much shorter than the
+	items in order, so this takes far fewer comparisons than merging them item by item */
+	end = c_ptr->sorted_size;
+	next = c_ptr->size;
+	for (i = tail_size - 1; i >= 0; i--)
+	{
+		int left = 0;
+		int right = end;
+		while (left < right)
+		{
+			int middle = (left + right) / 2;
+			if (c_ptr->comp_fun(buffer[i], c_ptr->array[middle]) < 0)
+			{
+				right = middle;
+			}
+			else
+			{
+				left = middle + 1;
+			}
+		}
+		while (end > left)
+		{
+			c_ptr->array[--next] = c_ptr->array[--end];
+		}
+		c_ptr->array[--next] = buffer[i];
+	}
+	free(buffer);
+	c_ptr->sorted_size = c_ptr->size;
+}
+
+/* Merge two runs of items in order into the destination */
+static void OC_merge_runs(OC_comp_fp_t comp_fun, void** first, int first_size, void** second, int second_size, void** destination)
+{
+	int i = 0, j = 0;
+	while (i < first_size && j < second_size)
+	{
+		if (comp_fun(second[j], first[i]) < 0)
+		{
+			*destination++ = second[j++];
+		}
+		else
+		{
+			*destination++ = first[i++];
+		}
+	}
+	while (i < first_size)
+	{
+		*destination++ = first[i++];
+	}
+	while (j < second_size)
+	{
+		*destination++ = second[j++];
+	}
+}
+
+#ifdef OC_RUNTIME_BACKENDS
+/* The table of this implementation's functions, for Ordered_container.c */
+OC_DEFINE_OPS(OC_array_ops);
+#else
+/* Create an empty container using the supplied comparison function, and return the pointer to it.
+This is the only implementation linked into the program, so it is used whatever backend is asked for. */
+struct Ordered_container* OC_create_container_backend(OC_comp_fp_t f_ptr, enum OC_backend backend)
+{
+	return OC_create_container(f_ptr);
+}
+
+/* Create an empty lazy container using the supplied comparison function, and return the pointer to it.
+This is the only implementation linked into the program, so it is used whatever backend is asked for. */
+struct Ordered_container* OC_create_lazy_container_backend(OC_comp_fp_t f_ptr, enum OC_backend backend)
+{
+	return OC_create_lazy_container(f_ptr);
+}
+#endif
+
 #endif
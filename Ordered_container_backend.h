@@ -0,0 +1,96 @@
+#ifndef ORDERED_CONTAINER_BACKEND_H
+#define ORDERED_CONTAINER_BACKEND_H
+
+/*
+This header is included by each implementation of Ordered_container in place of Ordered_container.h,
+after defining OC_BACKEND_PREFIX as the prefix for its function names, and by Ordered_container.c.
+
+When OC_RUNTIME_BACKENDS is not defined, an implementation defines the OC_ functions themselves,
+so that calls go straight to them. When it is defined, the functions of each implementation are
+renamed with its prefix so that they can all be linked into one program, each implementation
+provides a table of them, and the first member of each implementation's Ordered_container is
+a pointer to its table, which Ordered_container.c uses to call the container's implementation.
+
+The data pointer is the first member of the items of every implementation, so that
+OC_get_data_ptr does not need to know which implementation an item belongs to.
+*/
+
+#ifdef OC_RUNTIME_BACKENDS
+
+#define OC_PASTE_NAME(prefix, name) prefix##name
+#define OC_BACKEND_NAME(prefix, name) OC_PASTE_NAME(prefix, name)
+
+#ifdef OC_BACKEND_PREFIX
+#define OC_create_container OC_BACKEND_NAME(OC_BACKEND_PREFIX, create_container)
+#define OC_create_lazy_container OC_BACKEND_NAME(OC_BACKEND_PREFIX, create_lazy_container)
+#define OC_destroy_container OC_BACKEND_NAME(OC_BACKEND_PREFIX, destroy_container)
+#define OC_clear OC_BACKEND_NAME(OC_BACKEND_PREFIX, clear)
+#define OC_get_size OC_BACKEND_NAME(OC_BACKEND_PREFIX, get_size)
+#define OC_empty OC_BACKEND_NAME(OC_BACKEND_PREFIX, empty)
+#define OC_set_allocation_policy OC_BACKEND_NAME(OC_BACKEND_PREFIX, set_allocation_policy)
+#define OC_get_data_ptr OC_BACKEND_NAME(OC_BACKEND_PREFIX, get_data_ptr)
+#define OC_delete_item OC_BACKEND_NAME(OC_BACKEND_PREFIX, delete_item)
+#define OC_insert OC_BACKEND_NAME(OC_BACKEND_PREFIX, insert)
+#define OC_find_item OC_BACKEND_NAME(OC_BACKEND_PREFIX, find_item)
+#define OC_find_item_arg OC_BACKEND_NAME(OC_BACKEND_PREFIX, find_item_arg)
+#define OC_apply OC_BACKEND_NAME(OC_BACKEND_PREFIX, apply)
+#define OC_apply_if OC_BACKEND_NAME(OC_BACKEND_PREFIX, apply_if)
+#define OC_apply_arg OC_BACKEND_NAME(OC_BACKEND_PREFIX, apply_arg)
+#define OC_apply_if_arg OC_BACKEND_NAME(OC_BACKEND_PREFIX, apply_if_arg)
+#define OC_remove_if OC_BACKEND_NAME(OC_BACKEND_PREFIX, remove_if)
+#endif
+
+/* the first member of an implementation's Ordered_container */
+#define OC_OPS_MEMBER const struct OC_ops* ops;
+
+#else
+
+#define OC_OPS_MEMBER
+
+#endif
+
+#include "Ordered_container.h"
+
+#ifdef OC_RUNTIME_BACKENDS
+
+/* The functions of an implementation of Ordered_container */
+struct OC_ops {
+	struct Ordered_container* (*create_container)(OC_comp_fp_t f_ptr);
+	struct Ordered_container* (*create_lazy_container)(OC_comp_fp_t f_ptr);
+	void (*destroy_container)(struct Ordered_container* c_ptr);
+	void (*clear)(struct Ordered_container* c_ptr);
+	int (*get_size)(const struct Ordered_container* c_ptr);
+	int (*empty)(const struct Ordered_container* c_ptr);
+	void (*set_allocation_policy)(struct Ordered_container* c_ptr, const struct OC_allocation_policy* policy_ptr);
+	void (*delete_item)(struct Ordered_container* c_ptr, void* item_ptr);
+	void (*insert)(struct Ordered_container* c_ptr, const void* data_ptr);
+	void* (*find_item)(const struct Ordered_container* c_ptr, const void* data_ptr);
+	void* (*find_item_arg)(const struct Ordered_container* c_ptr, const void* arg_ptr, OC_find_item_arg_fp_t fafp);
+	void (*apply)(const struct Ordered_container* c_ptr, OC_apply_fp_t afp);
+	int (*apply_if)(const struct Ordered_container* c_ptr, OC_apply_if_fp_t afp);
+	void (*apply_arg)(const struct Ordered_container* c_ptr, OC_apply_arg_fp_t afp, void* arg_ptr);
+	int (*apply_if_arg)(const struct Ordered_container* c_ptr, OC_apply_if_arg_fp_t afp, void* arg_ptr);
+	int (*remove_if)(struct Ordered_container* c_ptr, OC_apply_if_arg_fp_t afp, void* arg_ptr);
+};
+
+/* The table of each implementation, in the order of enum OC_backend */
+extern const struct OC_ops OC_list_ops;
+extern const struct OC_ops OC_array_ops;
+extern const struct OC_ops OC_lsm_ops;
+extern const struct OC_ops OC_adaptive_ops;
+
+/* Define the table of the implementation that includes this header, with its functions */
+#define OC_DEFINE_OPS(table) const struct OC_ops table = { OC_create_container, OC_create_lazy_container, \
+	OC_destroy_container, OC_clear, OC_get_size, OC_empty, OC_set_allocation_policy, OC_delete_item, OC_insert, OC_find_item, \
+	OC_find_item_arg, OC_apply, OC_apply_if, OC_apply_arg, OC_apply_if_arg, OC_remove_if }
+
+/* Set the pointer to the implementation's table in a new container */
+#define OC_SET_OPS(c_ptr, table) ((c_ptr)->ops = &(table))
+
+#else
+
+#define OC_SET_OPS(c_ptr, table)
+
+#endif
+
+#endif
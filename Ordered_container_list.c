@@ -1,7 +1,8 @@
 #ifndef ORDERED_CONTAINER_LIST
 #define ORDERED_CONTAINER_LIST
 
-#include "Ordered_container.h"
+#define OC_BACKEND_PREFIX OC_list_
+#include "Ordered_container_backend.h"
 #include "Utility.h"
 #include "p1_globals.h"
 #include <stdlib.h>
@@ -15,30 +16,40 @@ node and another pointer to the next node in the list. This means insertions or
 removals of a node can be made in constant time, once the location has been
 determined. */
 struct LL_Node { 
+	void* data_ptr; 			/* uncommitted pointer to the data item */
     struct LL_Node* prev;      /* pointer to the previous node */
 	struct LL_Node* next;		/* pointer to the next node */
-	void* data_ptr; 			/* uncommitted pointer to the data item */
 };
 
 /* Declaration for Ordered_container. This declaration is local to this file.  
 A pointer is maintained to the last node in the list as well as the first, 
 meaning that additions to the end of the list can be made in constant time. 
 The number of nodes in the list is kept up-to-date in the size member
-variable, so that the size of the list can be accessed in constant time. */
+variable, so that the size of the list can be accessed in constant time.
+In a lazy container, the last tail_size nodes, starting with tail_first,
+are an unsorted tail in the order they were inserted. */
 struct Ordered_container {
+	OC_OPS_MEMBER
 	OC_comp_fp_t comp_func;
 	struct LL_Node* first;
 	struct LL_Node* last;
 	int size;
+	struct LL_Node* tail_first;	/* NULL if there is no tail */
+	int tail_size;
+	int lazy;					/* whether inserted nodes go in the tail */
 };
 
 /* Enum for OC_apply functions */
 typedef enum { APPLY, APPLY_IF, APPLY_ARG, APPLY_ARG_IF, APPLY_INTERNAL } apply_enum;
 
 /* These global variables are used to monitor the memory usage of the Ordered_container */
+#ifndef OC_RUNTIME_BACKENDS
 int g_Container_count = 0;				/* number of Ordered_containers currently allocated */
 int g_Container_items_in_use = 0;		/* number of Ordered_container items currently in use */
 int g_Container_items_allocated = 0;	/* number of Ordered_container items currently allocated */
+int g_Container_promotions = 0;			/* never changed, since this implementation has only one representation */
+int g_Container_demotions = 0;			/* never changed */
+#endif
 
 /*
 Private helper functions declarations
@@ -89,6 +100,12 @@ static void *OC_find_helper(const struct Ordered_container* c_ptr, OC_find_fp_t
 /* Deallocate all nodes */
 static void OC_deallocate_all(struct Ordered_container *c_ptr);
 
+/* Sort the tail of a lazy container and merge it into the nodes in order */
+static void OC_merge_tail(struct Ordered_container* c_ptr);
+
+/* Sort a list of nodes linked by their next pointers, and return its new first node */
+static struct LL_Node* OC_sort_nodes(OC_comp_fp_t comp_func, struct LL_Node* first, int size);
+
 /*
 Functions for the entire container.
 */
@@ -97,12 +114,22 @@ Functions for the entire container.
 struct Ordered_container* OC_create_container(OC_comp_fp_t f_ptr)
 {
 	struct Ordered_container *c_ptr = malloc(sizeof(struct Ordered_container));
+	OC_SET_OPS(c_ptr, OC_list_ops);
 	c_ptr->comp_func = f_ptr;
+	c_ptr->lazy = 0;
 	OC_initialize_container(c_ptr);
 	g_Container_count++;
 	return c_ptr;
 }
 
+/* Create an empty lazy container using the supplied comparison function, and return the pointer to it. */
+struct Ordered_container* OC_create_lazy_container(OC_comp_fp_t f_ptr)
+{
+	struct Ordered_container *c_ptr = OC_create_container(f_ptr);
+	c_ptr->lazy = 1;
+	return c_ptr;
+}
+
 /* Destroy the container and its items; caller is responsible for
 deleting all pointed-to data before calling this function.
 After this call, the container pointer value must not be used again. */
@@ -133,6 +160,12 @@ int OC_empty(const struct Ordered_container* c_ptr)
 	return c_ptr->size == 0;
 }
 
+/* Set how the container allocates memory for its items; this implementation ignores it,
+since a list allocates each node separately. */
+void OC_set_allocation_policy(struct Ordered_container* c_ptr, const struct OC_allocation_policy* policy_ptr)
+{
+}
+
 /*
 Functions for working with individual items in the container.
 */
@@ -148,6 +181,11 @@ Caller is responsible for any deletion of the data pointed to by the item. */
 void OC_delete_item(struct Ordered_container* c_ptr, void* item_ptr)
 {
 	struct LL_Node *node_ptr = (struct LL_Node*)item_ptr;
+	/* nodes keep their addresses when the tail is merged */
+	if (c_ptr->tail_size > 0)
+	{
+		OC_merge_tail(c_ptr);
+	}
 	if (node_ptr->next == NULL && node_ptr->prev == NULL)
 	{
 		/* container must now be empty */
@@ -194,6 +232,21 @@ void OC_insert(struct Ordered_container* c_ptr, const void* data_ptr)
 		c_ptr->first = new_node;
 		c_ptr->last = new_node;
 	}
+	else if (c_ptr->tail_size == 0 && c_ptr->comp_func(data_ptr, OC_get_data_ptr(c_ptr->last)) >= 0)
+	{
+		/* inserting in order (e.g. when restoring) goes at the end without a traversal */
+		OC_insert_after(c_ptr, c_ptr->last, data_ptr);
+	}
+	else if (c_ptr->lazy)
+	{
+		/* anything else in a lazy container goes at the end of the tail */
+		OC_insert_after(c_ptr, c_ptr->last, data_ptr);
+		if (c_ptr->tail_size == 0)
+		{
+			c_ptr->tail_first = c_ptr->last;
+		}
+		c_ptr->tail_size++;
+	}
 	else
 	{
 		int is_inserted = OC_apply_helper(c_ptr, (OC_apply_template_fp_t)OC_check_and_insert, (void*)data_ptr, APPLY_INTERNAL);
@@ -263,6 +316,48 @@ int OC_apply_if_arg(const struct Ordered_container* c_ptr, OC_apply_if_arg_fp_t
 	return OC_apply_helper(c_ptr, (OC_apply_template_fp_t)afp, arg_ptr, APPLY_ARG_IF);
 }
 
+/* Remove every item for whose data pointer the supplied function returns non-zero, and return
+the number of items removed; the function takes a second argument, which is the supplied void pointer. */
+int OC_remove_if(struct Ordered_container* c_ptr, OC_apply_if_arg_fp_t afp, void* arg_ptr)
+{
+	struct LL_Node *node_ptr, *next;
+	int removed = 0;
+	if (c_ptr->tail_size > 0)
+	{
+		OC_merge_tail(c_ptr);
+	}
+	/* the nodes are unlinked in one traversal */
+	for (node_ptr = c_ptr->first; node_ptr != NULL; node_ptr = next)
+	{
+		next = node_ptr->next;
+		if (!afp(node_ptr->data_ptr, arg_ptr))
+		{
+			continue;
+		}
+		if (node_ptr->prev != NULL)
+		{
+			node_ptr->prev->next = next;
+		}
+		else
+		{
+			c_ptr->first = next;
+		}
+		if (next != NULL)
+		{
+			next->prev = node_ptr->prev;
+		}
+		else
+		{
+			c_ptr->last = node_ptr->prev;
+		}
+		OC_deallocate_item(c_ptr, node_ptr, NULL);
+		removed++;
+	}
+	c_ptr->size -= removed;
+	OC_change_globals(-removed);
+	return removed;
+}
+
 /*
 Private helper functions
 */
@@ -280,6 +375,8 @@ static void OC_initialize_container(struct Ordered_container* c_ptr)
 	c_ptr->first = NULL;
 	c_ptr->last = NULL;
 	c_ptr->size = 0;
+	c_ptr->tail_first = NULL;
+	c_ptr->tail_size = 0;
 }
 
 /* Deallocates a single node */
@@ -370,7 +467,12 @@ static void *OC_check_and_find(const struct Ordered_container* c_ptr, void* item
 /* Helper function for OC_apply functions */
 static int OC_apply_helper(const struct Ordered_container* c_ptr, OC_apply_template_fp_t afp, void* arg_ptr, apply_enum apply_func)
 {
-	struct LL_Node *node_ptr = c_ptr->first;
+	struct LL_Node *node_ptr;
+	if (c_ptr->tail_size > 0 && apply_func != APPLY_INTERNAL)
+	{
+		OC_merge_tail((struct Ordered_container *)c_ptr);
+	}
+	node_ptr = c_ptr->first;
 	while (node_ptr != NULL)
 	{
 		struct LL_Node *next_node_ptr = node_ptr->next;
@@ -434,4 +536,105 @@ static void OC_deallocate_all(struct Ordered_container *c_ptr)
 	OC_apply_helper(c_ptr, (OC_apply_template_fp_t)OC_deallocate_item, NULL, APPLY_INTERNAL);
 }
 
+/* Sort the tail of a lazy container and merge it into the nodes in order */
+static void OC_merge_tail(struct Ordered_container* c_ptr)
+{
+	struct LL_Node *first = c_ptr->tail_first->prev == NULL ? NULL : c_ptr->first;
+	struct LL_Node *second = OC_sort_nodes(c_ptr->comp_func, c_ptr->tail_first, c_ptr->tail_size);
+	struct LL_Node *previous = NULL;
+	if (c_ptr->tail_first->prev != NULL)
+	{
+		c_ptr->tail_first->prev->next = NULL;
+	}
+	/* relink the nodes in order, fixing the prev pointers on the way */
+	c_ptr->first = NULL;
+	while (first != NULL || second != NULL)
+	{
+		struct LL_Node *node_ptr;
+		if (second == NULL || (first != NULL && c_ptr->comp_func(OC_get_data_ptr(second), OC_get_data_ptr(first)) >= 0))
+		{
+			node_ptr = first;
+			first = first->next;
+		}
+		else
+		{
+			node_ptr = second;
+			second = second->next;
+		}
+		node_ptr->prev = previous;
+		if (previous == NULL)
+		{
+			c_ptr->first = node_ptr;
+		}
+		else
+		{
+			previous->next = node_ptr;
+		}
+		previous = node_ptr;
+	}
+	previous->next = NULL;
+	c_ptr->last = previous;
+	c_ptr->tail_first = NULL;
+	c_ptr->tail_size = 0;
+}
+
+/* Sort a list of nodes linked by their next pointers, and return its new first node */
+static struct LL_Node* OC_sort_nodes(OC_comp_fp_t comp_func, struct LL_Node* first, int size)
+{
+	struct LL_Node *second, *merged, **end;
+	int first_size = size / 2;
+	int i;
+	if (size <= 1)
+	{
+		if (first != NULL)
+		{
+			first->next = NULL;
+		}
+		return first;
+	}
+	for (second = first, i = 0; i < first_size; i++)
+	{
+		second = second->next;
+	}
+	first = OC_sort_nodes(comp_func, first, first_size);
+	second = OC_sort_nodes(comp_func, second, size - first_size);
+	merged = NULL;
+	end = &merged;
+	while (first != NULL && second != NULL)
+	{
+		if (comp_func(OC_get_data_ptr(second), OC_get_data_ptr(first)) < 0)
+		{
+			*end = second;
+			second = second->next;
+		}
+		else
+		{
+			*end = first;
+			first = first->next;
+		}
+		end = &(*end)->next;
+	}
+	*end = (first != NULL) ? first : second;
+	return merged;
+}
+
+#ifdef OC_RUNTIME_BACKENDS
+/* The table of this implementation's functions, for Ordered_container.c */
+OC_DEFINE_OPS(OC_list_ops);
+#else
+/* Create an empty container using the supplied comparison function, and return the pointer to it.
+This is the only implementation linked into the program, so it is used whatever backend is asked for. */
+struct Ordered_container* OC_create_container_backend(OC_comp_fp_t f_ptr, enum OC_backend backend)
+{
+	return OC_create_container(f_ptr);
+}
+
+/* Create an empty lazy container using the supplied comparison function, and return the pointer to it.
+This is the only implementation linked into the program, so it is used whatever backend is asked for. */
+struct Ordered_container* OC_create_lazy_container_backend(OC_comp_fp_t f_ptr, enum OC_backend backend)
+{
+	return OC_create_lazy_container(f_ptr);
+}
+#endif
+
 #endif
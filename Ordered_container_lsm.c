@@ -0,0 +1,637 @@
+#ifndef ORDERED_CONTAINER_LSM
+#define ORDERED_CONTAINER_LSM
+
+#define OC_BACKEND_PREFIX OC_lsm_
+#include "Ordered_container_backend.h"
+#include "Utility.h"
+#include "p1_globals.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MEMTABLE_SIZE 64	/* items in the sorted run that is changed in place */
+#define TIER_FANOUT 4		/* runs of one size tier that are merged into a run of the next */
+
+/* An item of a run. A deleted item of a run that is not changed in place is marked dead
+(a tombstone) until its run is next rewritten. The data of a dead item may already have been
+deallocated by the user, so it is never compared. */
+struct LSM_Item {
+	void* data_ptr;
+	int dead;
+};
+
+/* A sorted run that is not changed in place except to mark items dead.
+first_live and last_live are the positions of its first and last live items, which are
+used as fence keys to skip the run in searches for data outside its range. */
+struct Run {
+	struct LSM_Item* items;
+	int size;			/* number of items, live and dead */
+	int live;			/* number of live items */
+	int first_live;
+	int last_live;
+};
+
+/* A complete type declaration for Ordered_container implemented as a log-structured merge tree.
+New items go into the memtable, a small sorted run changed in place. When it is full, it becomes
+the newest of the immutable runs, kept newest first; whenever the newest TIER_FANOUT or more
+runs are in the same size tier, they are merged into one run, dropping the dead items. */
+struct Ordered_container {
+	OC_OPS_MEMBER
+	OC_comp_fp_t comp_fun;	/* pointer to comparison function  */
+	struct LSM_Item memtable[MEMTABLE_SIZE];
+	int memtable_size;
+	struct Run* runs;		/* newest run first */
+	int run_count;
+	int run_allocation;
+	int size;				/* number of live items in the container */
+};
+
+/* Enum for OC_apply functions */
+typedef enum { APPLY, APPLY_IF, APPLY_ARG, APPLY_ARG_IF } apply_enum;
+
+/* These global variables are used to monitor the memory usage of the Ordered_container */
+#ifndef OC_RUNTIME_BACKENDS
+int g_Container_count = 0;				/* number of Ordered_containers currently allocated */
+int g_Container_items_in_use = 0;		/* number of Ordered_container items currently in use */
+int g_Container_items_allocated = 0;	/* number of Ordered_container items currently allocated */
+int g_Container_promotions = 0;			/* never changed, since this implementation has only one representation */
+int g_Container_demotions = 0;			/* never changed */
+#endif
+
+/*
+Private helper functions declarations
+*/
+
+/* Initialize the container to default values */
+static void OC_initialize_container(struct Ordered_container* c_ptr);
+
+/* Deallocate all runs in the container */
+static void OC_deallocate_all(struct Ordered_container* c_ptr);
+
+/* Return the position of the first live item in the range [left, right) that does not come before
+the argument, or right if there is none */
+static int OC_lower_bound(const struct LSM_Item* items, int left, int right, const void* arg_ptr, OC_find_item_arg_fp_t fafp);
+
+/* Make the memtable the newest run, and merge runs as needed */
+static void OC_flush_memtable(struct Ordered_container* c_ptr);
+
+/* Merge the count newest runs into one run of their live items */
+static void OC_merge_newest_runs(struct Ordered_container* c_ptr, int count);
+
+/* Return the size tier of a run with the given number of items */
+static int OC_run_tier(int size);
+
+/* Rewrite a run without its dead items, removing it if there are none left */
+static void OC_compact_run(struct Ordered_container* c_ptr, int run_index);
+
+/* Type of function used to pass function pointers around OC_apply functions */
+typedef void(*OC_apply_template_fp_t) (void);
+
+/* Helper function for OC_apply functions; visits the live items of all runs in order */
+static int OC_apply_helper(const struct Ordered_container* c_ptr, OC_apply_template_fp_t afp, void* arg_ptr, apply_enum apply_func);
+
+/*
+Functions for the entire container.
+*/
+
+/* Create an empty container using the supplied comparison function, and return the pointer to it. */
+struct Ordered_container* OC_create_container(OC_comp_fp_t f_ptr)
+{
+	struct Ordered_container *c_ptr = malloc(sizeof(struct Ordered_container));
+	OC_SET_OPS(c_ptr, OC_lsm_ops);
+	c_ptr->comp_fun = f_ptr;
+	OC_initialize_container(c_ptr);
+	g_Container_count++;
+	return c_ptr;
+}
+
+/* Create an empty lazy container using the supplied comparison function, and return the pointer to it.
+Insertions only ever sort the small memtable, so a lazy container is the same as any other. */
+struct Ordered_container* OC_create_lazy_container(OC_comp_fp_t f_ptr)
+{
+	return OC_create_container(f_ptr);
+}
+
+/* Destroy the container and its items; caller is responsible for
+deleting all pointed-to data before calling this function.
+After this call, the container pointer value must not be used again. */
+void OC_destroy_container(struct Ordered_container* c_ptr)
+{
+	OC_deallocate_all(c_ptr);
+	free(c_ptr);
+	g_Container_count--;
+}
+
+/* Delete all the items in the container and initialize it.
+Caller is responsible for deleting any pointed-to data first. */
+void OC_clear(struct Ordered_container* c_ptr)
+{
+	OC_deallocate_all(c_ptr);
+	OC_initialize_container(c_ptr);
+}
+
+/* Return the number of items currently stored in the container */
+int OC_get_size(const struct Ordered_container* c_ptr)
+{
+	return c_ptr->size;
+}
+
+/* Return non-zero (true) if the container is empty, zero (false) if the container is non-empty */
+int OC_empty(const struct Ordered_container* c_ptr)
+{
+	return c_ptr->size == 0;
+}
+
+/* Set how the container allocates memory for its items; this implementation ignores it,
+since runs are allocated at their final size. */
+void OC_set_allocation_policy(struct Ordered_container* c_ptr, const struct OC_allocation_policy* policy_ptr)
+{
+}
+
+/*
+Functions for working with individual items in the container.
+*/
+
+/* Get the data object pointer from an item. */
+void* OC_get_data_ptr(const void* item_ptr)
+{
+	return ((const struct LSM_Item*)item_ptr)->data_ptr;
+}
+
+/* Delete the specified item.
+Caller is responsible for any deletion of the data pointed to by the item. */
+void OC_delete_item(struct Ordered_container* c_ptr, void* item_ptr)
+{
+	struct LSM_Item *item = (struct LSM_Item*)item_ptr;
+	c_ptr->size--;
+	g_Container_items_in_use--;
+	if (item >= c_ptr->memtable && item < c_ptr->memtable + c_ptr->memtable_size)
+	{
+		/* the memtable is changed in place */
+		memmove(item, item + 1, (c_ptr->memtable + c_ptr->memtable_size - item - 1) * sizeof(struct LSM_Item));
+		c_ptr->memtable_size--;
+	}
+	else
+	{
+		int i;
+		for (i = 0; i < c_ptr->run_count; i++)
+		{
+			struct Run *run = &c_ptr->runs[i];
+			if (item >= run->items && item < run->items + run->size)
+			{
+				item->dead = 1;
+				run->live--;
+				while (run->first_live < run->size && run->items[run->first_live].dead)
+				{
+					run->first_live++;
+				}
+				while (run->last_live >= 0 && run->items[run->last_live].dead)
+				{
+					run->last_live--;
+				}
+				/* a run that is mostly tombstones is rewritten, so that searches and traversals
+				do not have to skip over them */
+				if (run->live * 2 < run->size)
+				{
+					OC_compact_run(c_ptr, i);
+				}
+				return;
+			}
+		}
+	}
+}
+
+/*
+Functions that search and insert into the container using the supplied comparison function.
+*/
+
+/* Create a new item for the specified data pointer and put it in the container in order.
+If there is already an item in the container that compares equal to new item according to
+the comparison function, the order of the new item relative to the existing item is not specified.
+This function will not modify the pointed-to data. */
+void OC_insert(struct Ordered_container* c_ptr, const void* data_ptr)
+{
+	int left = 0;
+	int right;
+	if (c_ptr->memtable_size == MEMTABLE_SIZE)
+	{
+		OC_flush_memtable(c_ptr);
+	}
+	right = c_ptr->memtable_size;
+	/* find the position after the items that do not come after the new one */
+	while (left < right)
+	{
+		int middle = (left + right) / 2;
+		if (c_ptr->comp_fun(data_ptr, c_ptr->memtable[middle].data_ptr) < 0)
+		{
+			right = middle;
+		}
+		else
+		{
+			left = middle + 1;
+		}
+	}
+	memmove(c_ptr->memtable + left + 1, c_ptr->memtable + left, (c_ptr->memtable_size - left) * sizeof(struct LSM_Item));
+	c_ptr->memtable[left].data_ptr = (void*)data_ptr;
+	c_ptr->memtable[left].dead = 0;
+	c_ptr->memtable_size++;
+	c_ptr->size++;
+	g_Container_items_in_use++;
+}
+
+/* Return a pointer to an item that points to data equal to the data object pointed to by data_ptr,
+using the ordering function to do the comparison with data_ptr as the first argument.
+The data_ptr object is assumed to be of the same type as the data objects pointed to by container items.
+NULL is returned if no matching item is found. If more than one matching item is present, it is
+unspecified which one is returned. The pointed-to data will not be modified. */
+void* OC_find_item(const struct Ordered_container* c_ptr, const void* data_ptr)
+{
+	return OC_find_item_arg(c_ptr, data_ptr, c_ptr->comp_fun);
+}
+
+/* Return a pointer to the item that points to data that matches the supplied argument given by arg_ptr
+according to the supplied function, which compares arg_ptr as the first argument with the data pointer
+in each item. This function does not require that arg_ptr be of the same type as the data objects, and
+so allows the container to be searched without creating a complete data object first.
+NULL is returned if no matching item is found. If more than one matching item is present, it is
+unspecified which one is returned. The comparison function must implement an ordering consistent
+with the ordering produced by the comparison function specified when the container was created;
+if not, the result is undefined. */
+void* OC_find_item_arg(const struct Ordered_container* c_ptr, const void* arg_ptr, OC_find_item_arg_fp_t fafp)
+{
+	int i, position;
+	position = OC_lower_bound(c_ptr->memtable, 0, c_ptr->memtable_size, arg_ptr, fafp);
+	if (position < c_ptr->memtable_size && fafp(arg_ptr, c_ptr->memtable[position].data_ptr) == 0)
+	{
+		return (void*)(c_ptr->memtable + position);
+	}
+	/* the runs are searched newest first, skipping those whose fence keys show the data cannot be there */
+	for (i = 0; i < c_ptr->run_count; i++)
+	{
+		const struct Run *run = &c_ptr->runs[i];
+		if (run->live == 0 || fafp(arg_ptr, run->items[run->first_live].data_ptr) < 0
+			|| fafp(arg_ptr, run->items[run->last_live].data_ptr) > 0)
+		{
+			continue;
+		}
+		position = OC_lower_bound(run->items, run->first_live, run->last_live + 1, arg_ptr, fafp);
+		if (position <= run->last_live && fafp(arg_ptr, run->items[position].data_ptr) == 0)
+		{
+			return run->items + position;
+		}
+	}
+	return NULL;
+}
+
+/* Functions that traverse the items in the container, processing each item in order. */
+
+/* Apply the supplied function to the data pointer in each item of the container.
+The contents of the container cannot be modified. */
+void OC_apply(const struct Ordered_container* c_ptr, OC_apply_fp_t afp)
+{
+	OC_apply_helper(c_ptr, (OC_apply_template_fp_t)afp, NULL, APPLY);
+}
+
+/* Apply the supplied function to the data pointer in each item in the container.
+If the function returns non-zero, the iteration is terminated, and that value
+returned. Otherwise, zero is returned. The contents of the container cannot be modified. */
+int OC_apply_if(const struct Ordered_container* c_ptr, OC_apply_if_fp_t afp)
+{
+	return OC_apply_helper(c_ptr, (OC_apply_template_fp_t)afp, NULL, APPLY_IF);
+}
+
+/* Apply the supplied function to the data pointer in each item in the container;
+the function takes a second argument, which is the supplied void pointer.
+The contents of the container cannot be modified. */
+void OC_apply_arg(const struct Ordered_container* c_ptr, OC_apply_arg_fp_t afp, void* arg_ptr)
+{
+	OC_apply_helper(c_ptr, (OC_apply_template_fp_t)afp, arg_ptr, APPLY_ARG);
+}
+
+/* Apply the supplied function to the data pointer in each item in the container;
+the function takes a second argument, which is the supplied void pointer.
+If the function returns non-zero, the iteration is terminated, and that value
+returned. Otherwise, zero is returned. The contents of the container cannot be modified */
+int OC_apply_if_arg(const struct Ordered_container* c_ptr, OC_apply_if_arg_fp_t afp, void* arg_ptr)
+{
+	return OC_apply_helper(c_ptr, (OC_apply_template_fp_t)afp, arg_ptr, APPLY_ARG_IF);
+}
+
+/* Remove every item for whose data pointer the supplied function returns non-zero, and return
+the number of items removed; the function takes a second argument, which is the supplied void pointer. */
+int OC_remove_if(struct Ordered_container* c_ptr, OC_apply_if_arg_fp_t afp, void* arg_ptr)
+{
+	int kept = 0;
+	int removed = 0;
+	int i, j;
+	for (i = 0; i < c_ptr->memtable_size; i++)
+	{
+		if (!afp(c_ptr->memtable[i].data_ptr, arg_ptr))
+		{
+			c_ptr->memtable[kept++] = c_ptr->memtable[i];
+		}
+	}
+	removed += c_ptr->memtable_size - kept;
+	c_ptr->memtable_size = kept;
+	/* the removed items of the runs are marked dead, and the runs that are mostly dead rewritten */
+	for (i = c_ptr->run_count - 1; i >= 0; i--)
+	{
+		struct Run *run = &c_ptr->runs[i];
+		for (j = run->first_live; j <= run->last_live; j++)
+		{
+			if (!run->items[j].dead && afp(run->items[j].data_ptr, arg_ptr))
+			{
+				run->items[j].dead = 1;
+				run->live--;
+				removed++;
+			}
+		}
+		while (run->first_live < run->size && run->items[run->first_live].dead)
+		{
+			run->first_live++;
+		}
+		while (run->last_live >= 0 && run->items[run->last_live].dead)
+		{
+			run->last_live--;
+		}
+		if (run->live * 2 < run->size)
+		{
+			OC_compact_run(c_ptr, i);
+		}
+	}
+	c_ptr->size -= removed;
+	g_Container_items_in_use -= removed;
+	return removed;
+}
+
+/*
+Private helper functions
+*/
+
+/* Initialize the container to default values */
+static void OC_initialize_container(struct Ordered_container* c_ptr)
+{
+	c_ptr->memtable_size = 0;
+	c_ptr->runs = NULL;
+	c_ptr->run_count = 0;
+	c_ptr->run_allocation = 0;
+	c_ptr->size = 0;
+	g_Container_items_allocated += MEMTABLE_SIZE;
+}
+
+/* Deallocate all runs in the container */
+static void OC_deallocate_all(struct Ordered_container* c_ptr)
+{
+	int i;
+	for (i = 0; i < c_ptr->run_count; i++)
+	{
+		g_Container_items_allocated -= c_ptr->runs[i].size;
+		free(c_ptr->runs[i].items);
+	}
+	free(c_ptr->runs);
+	g_Container_items_in_use -= c_ptr->size;
+	g_Container_items_allocated -= MEMTABLE_SIZE;
+}
+
+/* Return the position of the first live item in the range [left, right) that does not come before
+the argument, or right if there is none */
+static int OC_lower_bound(const struct LSM_Item* items, int left, int right, const void* arg_ptr, OC_find_item_arg_fp_t fafp)
+{
+	int end = right;
+	while (left < right)
+	{
+		int middle = (left + right) / 2;
+		int live = middle;
+		/* compare with the first live item from the middle on, since dead items' data may be gone */
+		while (live < right && items[live].dead)
+		{
+			live++;
+		}
+		if (live == right)
+		{
+			right = middle;
+		}
+		else if (fafp(arg_ptr, items[live].data_ptr) > 0)
+		{
+			left = live + 1;
+		}
+		else
+		{
+			right = live;
+		}
+	}
+	while (left < end && items[left].dead)
+	{
+		left++;
+	}
+	return left;
+}
+
+/* Make the memtable the newest run, and merge runs as needed */
+static void OC_flush_memtable(struct Ordered_container* c_ptr)
+{
+	struct Run *run;
+	if (c_ptr->run_count == c_ptr->run_allocation)
+	{
+		c_ptr->run_allocation = c_ptr->run_allocation * 2 + 1;
+		c_ptr->runs = realloc(c_ptr->runs, c_ptr->run_allocation * sizeof(struct Run));
+	}
+	memmove(c_ptr->runs + 1, c_ptr->runs, c_ptr->run_count * sizeof(struct Run));
+	c_ptr->run_count++;
+	run = &c_ptr->runs[0];
+	run->items = malloc(c_ptr->memtable_size * sizeof(struct LSM_Item));
+	memcpy(run->items, c_ptr->memtable, c_ptr->memtable_size * sizeof(struct LSM_Item));
+	run->size = c_ptr->memtable_size;
+	run->live = c_ptr->memtable_size;
+	run->first_live = 0;
+	run->last_live = c_ptr->memtable_size - 1;
+	g_Container_items_allocated += run->size;
+	c_ptr->memtable_size = 0;
+	for (;;)
+	{
+		int tier = OC_run_tier(c_ptr->runs[0].size);
+		int count = 1;
+		while (count < c_ptr->run_count && OC_run_tier(c_ptr->runs[count].size) == tier)
+		{
+			count++;
+		}
+		if (count < TIER_FANOUT)
+		{
+			break;
+		}
+		OC_merge_newest_runs(c_ptr, count);
+	}
+}
+
+/* Merge the count newest runs into one run of their live items */
+static void OC_merge_newest_runs(struct Ordered_container* c_ptr, int count)
+{
+	struct Run merged;
+	int *positions = malloc(count * sizeof(int));
+	int total = 0;
+	int i;
+	for (i = 0; i < count; i++)
+	{
+		total += c_ptr->runs[i].live;
+		positions[i] = c_ptr->runs[i].first_live;
+	}
+	merged.items = malloc((total > 0 ? total : 1) * sizeof(struct LSM_Item));
+	merged.size = 0;
+	while (merged.size < total)
+	{
+		int best = -1;
+		for (i = 0; i < count; i++)
+		{
+			const struct Run *run = &c_ptr->runs[i];
+			if (positions[i] <= run->last_live && (best < 0 || c_ptr->comp_fun(run->items[positions[i]].data_ptr,
+				c_ptr->runs[best].items[positions[best]].data_ptr) < 0))
+			{
+				best = i;
+			}
+		}
+		merged.items[merged.size++] = c_ptr->runs[best].items[positions[best]];
+		do
+		{
+			positions[best]++;
+		} while (positions[best] <= c_ptr->runs[best].last_live && c_ptr->runs[best].items[positions[best]].dead);
+	}
+	free(positions);
+	for (i = 0; i < count; i++)
+	{
+		g_Container_items_allocated -= c_ptr->runs[i].size;
+		free(c_ptr->runs[i].items);
+	}
+	merged.live = total;
+	merged.first_live = 0;
+	merged.last_live = total - 1;
+	g_Container_items_allocated += total;
+	c_ptr->runs[0] = merged;
+	memmove(c_ptr->runs + 1, c_ptr->runs + count, (c_ptr->run_count - count) * sizeof(struct Run));
+	c_ptr->run_count -= count - 1;
+}
+
+/* Return the size tier of a run with the given number of items */
+static int OC_run_tier(int size)
+{
+	int tier = 0;
+	int limit = MEMTABLE_SIZE * TIER_FANOUT;
+	while (size >= limit)
+	{
+		tier++;
+		limit *= TIER_FANOUT;
+	}
+	return tier;
+}
+
+/* Rewrite a run without its dead items, removing it if there are none left */
+static void OC_compact_run(struct Ordered_container* c_ptr, int run_index)
+{
+	struct Run *run = &c_ptr->runs[run_index];
+	int i, live = 0;
+	g_Container_items_allocated -= run->size - run->live;
+	if (run->live == 0)
+	{
+		free(run->items);
+		memmove(run, run + 1, (c_ptr->run_count - run_index - 1) * sizeof(struct Run));
+		c_ptr->run_count--;
+		return;
+	}
+	for (i = run->first_live; i <= run->last_live; i++)
+	{
+		if (!run->items[i].dead)
+		{
+			run->items[live++] = run->items[i];
+		}
+	}
+	run->items = realloc(run->items, live * sizeof(struct LSM_Item));
+	run->size = live;
+	run->first_live = 0;
+	run->last_live = live - 1;
+}
+
+/* Helper function for OC_apply functions; visits the live items of all runs in order */
+static int OC_apply_helper(const struct Ordered_container* c_ptr, OC_apply_template_fp_t afp, void* arg_ptr, apply_enum apply_func)
+{
+	/* the memtable is treated as one more run, after the others */
+	int run_count = c_ptr->run_count + 1;
+	int *positions = malloc(run_count * sizeof(int));
+	int *lasts = malloc(run_count * sizeof(int));
+	const struct LSM_Item **items = malloc(run_count * sizeof(struct LSM_Item *));
+	int function_return = 0;
+	int i;
+	for (i = 0; i < c_ptr->run_count; i++)
+	{
+		items[i] = c_ptr->runs[i].items;
+		positions[i] = c_ptr->runs[i].first_live;
+		lasts[i] = c_ptr->runs[i].last_live;
+	}
+	items[i] = c_ptr->memtable;
+	positions[i] = 0;
+	lasts[i] = c_ptr->memtable_size - 1;
+	for (;;)
+	{
+		void *data_ptr;
+		int best = -1;
+		/* the function may deallocate the data, so only items it has not been applied to are compared */
+		for (i = 0; i < run_count; i++)
+		{
+			if (positions[i] <= lasts[i] && (best < 0 || c_ptr->comp_fun(items[i][positions[i]].data_ptr,
+				items[best][positions[best]].data_ptr) < 0))
+			{
+				best = i;
+			}
+		}
+		if (best < 0)
+		{
+			break;
+		}
+		data_ptr = items[best][positions[best]].data_ptr;
+		do
+		{
+			positions[best]++;
+		} while (positions[best] <= lasts[best] && items[best][positions[best]].dead);
+		switch (apply_func)
+		{
+		case APPLY:
+			((OC_apply_fp_t)afp)(data_ptr);
+			break;
+		case APPLY_IF:
+			function_return = ((OC_apply_if_fp_t)afp)(data_ptr);
+			break;
+		case APPLY_ARG:
+			((OC_apply_arg_fp_t)afp)(data_ptr, arg_ptr);
+			break;
+		case APPLY_ARG_IF:
+			function_return = ((OC_apply_if_arg_fp_t)afp)(data_ptr, arg_ptr);
+			break;
+		}
+		if (function_return)
+		{
+			break;
+		}
+	}
+	free(positions);
+	free(lasts);
+	free(items);
+	return function_return;
+}
+
+#ifdef OC_RUNTIME_BACKENDS
+/* The table of this implementation's functions, for Ordered_container.c */
+OC_DEFINE_OPS(OC_lsm_ops);
+#else
+/* Create an empty container using the supplied comparison function, and return the pointer to it.
+This is the only implementation linked into the program, so it is used whatever backend is asked for. */
+struct Ordered_container* OC_create_container_backend(OC_comp_fp_t f_ptr, enum OC_backend backend)
+{
+	return OC_create_container(f_ptr);
+}
+
+/* Create an empty lazy container using the supplied comparison function, and return the pointer to it.
+This is the only implementation linked into the program, so it is used whatever backend is asked for. */
+struct Ordered_container* OC_create_lazy_container_backend(OC_comp_fp_t f_ptr, enum OC_backend backend)
+{
+	return OC_create_lazy_container(f_ptr);
+}
+#endif
+
+#endif
@@ -0,0 +1,199 @@
+#define _POSIX_C_SOURCE 200112L
+#include "Output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <pthread.h>
+
+#define OUTPUT_BUFFER_SIZE 65536
+#define INT_DIGITS_MAX 11
+
+struct Output {
+	FILE* stream;						/* where the buffer is written; NULL for standard output */
+	int used;							/* number of characters in buffer */
+	int held;							/* non-zero if full buffers are kept rather than written */
+	char* kept;							/* the full buffers kept, in order, or NULL */
+	long kept_used;						/* number of characters in kept */
+	long kept_size;						/* number of characters kept has room for */
+	char buffer[OUTPUT_BUFFER_SIZE];	/* characters printed but not yet written */
+};
+
+static struct Output standard_output;	/* used by every thread that has not selected its own */
+static pthread_key_t current_output_key;
+static pthread_once_t current_output_once = PTHREAD_ONCE_INIT;
+
+/* Create the key holding each thread's selected Output */
+static void create_current_output_key(void);
+
+/* Return the Output selected by the calling thread */
+static struct Output* current_Output(void);
+
+/* Make room for at least the given number of characters in the buffer */
+static void output_reserve(struct Output* output, int length);
+
+/* Write the buffer to the Output's stream and empty it */
+static void output_write(struct Output* output);
+
+/* Move the buffer to the end of the kept characters and empty it */
+static void output_keep(struct Output* output);
+
+/* Create an Output object with its own buffer that writes to the stream. */
+struct Output* create_Output(FILE* stream)
+{
+	struct Output *output = malloc(sizeof(struct Output));
+	output->stream = stream;
+	output->used = 0;
+	output->held = 0;
+	output->kept = NULL;
+	output->kept_used = 0;
+	output->kept_size = 0;
+	return output;
+}
+
+/* Destroy an Output object after writing its buffer; the stream is not closed. */
+void destroy_Output(struct Output* output_ptr)
+{
+	output_write(output_ptr);
+	fflush(output_ptr->stream);
+	free(output_ptr->kept);
+	free(output_ptr);
+}
+
+/* Direct everything printed by the calling thread to the Output object, 
+or to standard output again if output_ptr is NULL. */
+void set_current_Output(struct Output* output_ptr)
+{
+	pthread_once(&current_output_once, create_current_output_key);
+	pthread_setspecific(current_output_key, output_ptr);
+}
+
+/* While held is non-zero, nothing the calling thread prints is written until output_flush
+is called, however much of it there is, rather than whenever the buffer fills up. */
+void hold_output(int held)
+{
+	current_Output()->held = held;
+}
+
+/* Print a C-string. */
+void output_string(const char* string)
+{
+	struct Output *output = current_Output();
+	while (*string)
+	{
+		if (output->used == OUTPUT_BUFFER_SIZE)
+		{
+			output_reserve(output, 1);
+		}
+		output->buffer[output->used++] = *string++;
+	}
+}
+
+/* Print a single character. */
+void output_char(char character)
+{
+	struct Output *output = current_Output();
+	output_reserve(output, 1);
+	output->buffer[output->used++] = character;
+}
+
+/* Print an integer in decimal. */
+void output_int(int value)
+{
+	struct Output *output = current_Output();
+	char digits[INT_DIGITS_MAX];
+	int count = 0;
+	/* negate as unsigned so that the most negative int is handled */
+	unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+	do
+	{
+		digits[count++] = (char)('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude > 0);
+	output_reserve(output, count + 1);
+	if (value < 0)
+	{
+		output->buffer[output->used++] = '-';
+	}
+	while (count > 0)
+	{
+		output->buffer[output->used++] = digits[--count];
+	}
+}
+
+/* Print with printf-style formatting; the result must not be longer than
+OUTPUT_FORMAT_MAX characters, which is enough for any message with a title in it. */
+void output_format(const char* format, ...)
+{
+	struct Output *output = current_Output();
+	va_list args;
+	output_reserve(output, OUTPUT_FORMAT_MAX + 1);
+	va_start(args, format);
+	output->used += vsprintf(output->buffer + output->used, format, args);
+	va_end(args);
+}
+
+/* Write everything printed so far to standard output, or to the selected Output object. */
+void output_flush(void)
+{
+	struct Output *output = current_Output();
+	output_write(output);
+	fflush(output->stream ? output->stream : stdout);
+}
+
+/* Create the key holding each thread's selected Output */
+static void create_current_output_key(void)
+{
+	pthread_key_create(&current_output_key, NULL);
+}
+
+/* Return the Output selected by the calling thread */
+static struct Output* current_Output(void)
+{
+	struct Output *output;
+	pthread_once(&current_output_once, create_current_output_key);
+	output = pthread_getspecific(current_output_key);
+	return output ? output : &standard_output;
+}
+
+/* Make room for at least the given number of characters in the buffer */
+static void output_reserve(struct Output* output, int length)
+{
+	if (output->used + length > OUTPUT_BUFFER_SIZE)
+	{
+		if (output->held)
+		{
+			output_keep(output);
+		}
+		else
+		{
+			output_write(output);
+		}
+	}
+}
+
+/* Write the buffer to the Output's stream and empty it */
+static void output_write(struct Output* output)
+{
+	FILE *stream = output->stream ? output->stream : stdout;
+	if (output->kept_used > 0)
+	{
+		fwrite(output->kept, 1, output->kept_used, stream);
+		output->kept_used = 0;
+	}
+	fwrite(output->buffer, 1, output->used, stream);
+	output->used = 0;
+}
+
+/* Move the buffer to the end of the kept characters and empty it */
+static void output_keep(struct Output* output)
+{
+	if (output->kept_used + output->used > output->kept_size)
+	{
+		output->kept_size = output->kept_size ? 2 * output->kept_size : OUTPUT_BUFFER_SIZE;
+		output->kept = realloc(output->kept, output->kept_size);
+	}
+	memcpy(output->kept + output->kept_used, output->buffer, output->used);
+	output->kept_used += output->used;
+	output->used = 0;
+}
@@ -0,0 +1,53 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+/* 
+Output collects everything printed to standard output in a large buffer, and writes
+the buffer with a single fwrite when it fills up or is flushed. Record data is formatted
+directly into the buffer, with integers converted by hand, so that printing a large
+library does not go through printf's format parser once per record.
+
+Everything printed to standard output must go through these functions so that it
+appears in order, and the output must be flushed before waiting for the user to type input.
+
+A thread can select an Output object of its own, such as one writing to a client's socket,
+and then everything that thread prints goes to that Output instead of standard output.
+*/
+
+#include <stdio.h> /* for the declaration of FILE */
+
+/* incomplete declaration */
+struct Output;
+
+/* Create an Output object with its own buffer that writes to the stream. */
+struct Output* create_Output(FILE* stream);
+
+/* Destroy an Output object after writing its buffer; the stream is not closed. */
+void destroy_Output(struct Output* output_ptr);
+
+/* Direct everything printed by the calling thread to the Output object, 
+or to standard output again if output_ptr is NULL. */
+void set_current_Output(struct Output* output_ptr);
+
+/* While held is non-zero, nothing the calling thread prints is written until output_flush
+is called, however much of it there is, rather than whenever the buffer fills up. */
+void hold_output(int held);
+
+/* Print a C-string. */
+void output_string(const char* string);
+
+/* Print a single character. */
+void output_char(char character);
+
+/* Print an integer in decimal. */
+void output_int(int value);
+
+/* Print with printf-style formatting; the result must not be longer than
+OUTPUT_FORMAT_MAX characters, which is enough for any message with a title in it. */
+#define OUTPUT_FORMAT_MAX 255
+void output_format(const char* format, ...);
+
+/* Write everything printed so far to standard output, or to the selected Output object. */
+void output_flush(void);
+
+#endif
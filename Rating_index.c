@@ -0,0 +1,157 @@
+#include "Rating_index.h"
+#include "Record.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define RATING_LIMIT 10		/* the largest rating in a valid save file */
+
+/* the records with one rating, in ID order */
+struct Rating_bucket {
+	struct Record** records;
+	int size;
+	int allocation;
+};
+
+/* a Rating_index contains a bucket for every rating */
+struct Rating_index {
+	struct Rating_bucket buckets[RATING_LIMIT + 1];
+};
+
+/* Return the position of the first record in the bucket whose ID is not less than the given ID */
+static int bucket_lower_bound(const struct Rating_bucket* bucket_ptr, int ID);
+
+/* Limit a range of ratings to the ratings that have buckets; the range is empty if low > high */
+static void limit_range(int* low_ptr, int* high_ptr);
+
+/* Create an empty Rating_index object. */
+struct Rating_index* create_Rating_index(void)
+{
+	struct Rating_index *index = malloc(sizeof(struct Rating_index));
+	int rating;
+	for (rating = 0; rating <= RATING_LIMIT; rating++)
+	{
+		index->buckets[rating].records = NULL;
+		index->buckets[rating].size = 0;
+		index->buckets[rating].allocation = 0;
+	}
+	return index;
+}
+
+/* Destroy a Rating_index object; the records are not destroyed. */
+void destroy_Rating_index(struct Rating_index* index_ptr)
+{
+	int rating;
+	for (rating = 0; rating <= RATING_LIMIT; rating++)
+	{
+		free(index_ptr->buckets[rating].records);
+	}
+	free(index_ptr);
+}
+
+/* Add a record to the index under its current rating. */
+void add_Rating_index_record(struct Rating_index* index_ptr, struct Record* record_ptr)
+{
+	struct Rating_bucket *bucket = &index_ptr->buckets[get_Record_rating(record_ptr)];
+	int position;
+	if (bucket->size == bucket->allocation)
+	{
+		bucket->allocation = bucket->allocation * 2 + 1;
+		bucket->records = realloc(bucket->records, bucket->allocation * sizeof(struct Record *));
+	}
+	/* new records have the largest ID, so this is usually the end of the bucket */
+	if (bucket->size == 0 || get_Record_ID(bucket->records[bucket->size - 1]) < get_Record_ID(record_ptr))
+	{
+		position = bucket->size;
+	}
+	else
+	{
+		position = bucket_lower_bound(bucket, get_Record_ID(record_ptr));
+		memmove(bucket->records + position + 1, bucket->records + position, (bucket->size - position) * sizeof(struct Record *));
+	}
+	bucket->records[position] = record_ptr;
+	bucket->size++;
+}
+
+/* Remove a record from the index; it must have the rating it was added with. */
+void remove_Rating_index_record(struct Rating_index* index_ptr, struct Record* record_ptr)
+{
+	struct Rating_bucket *bucket = &index_ptr->buckets[get_Record_rating(record_ptr)];
+	int position = bucket_lower_bound(bucket, get_Record_ID(record_ptr));
+	if (position < bucket->size && bucket->records[position] == record_ptr)
+	{
+		bucket->size--;
+		memmove(bucket->records + position, bucket->records + position + 1, (bucket->size - position) * sizeof(struct Record *));
+	}
+}
+
+/* Remove all records from the index. */
+void clear_Rating_index(struct Rating_index* index_ptr)
+{
+	int rating;
+	for (rating = 0; rating <= RATING_LIMIT; rating++)
+	{
+		index_ptr->buckets[rating].size = 0;
+	}
+}
+
+/* Return the number of records with ratings from low to high, inclusive. */
+int get_Rating_index_count(const struct Rating_index* index_ptr, int low, int high)
+{
+	int count = 0;
+	int rating;
+	limit_range(&low, &high);
+	for (rating = low; rating <= high; rating++)
+	{
+		count += index_ptr->buckets[rating].size;
+	}
+	return count;
+}
+
+/* Apply the function to at most count records with ratings from low to high, inclusive,
+highest rating first and in ID order for equal ratings. */
+void apply_Rating_index(const struct Rating_index* index_ptr, int low, int high, int count, Rating_index_apply_fp_t func_ptr)
+{
+	int rating, i;
+	limit_range(&low, &high);
+	for (rating = high; rating >= low && count > 0; rating--)
+	{
+		const struct Rating_bucket *bucket = &index_ptr->buckets[rating];
+		for (i = 0; i < bucket->size && count > 0; i++, count--)
+		{
+			func_ptr(bucket->records[i]);
+		}
+	}
+}
+
+/* Return the position of the first record in the bucket whose ID is not less than the given ID */
+static int bucket_lower_bound(const struct Rating_bucket* bucket_ptr, int ID)
+{
+	int low = 0;
+	int high = bucket_ptr->size;
+	while (low < high)
+	{
+		int middle = low + (high - low) / 2;
+		if (get_Record_ID(bucket_ptr->records[middle]) < ID)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return low;
+}
+
+/* Limit a range of ratings to the ratings that have buckets; the range is empty if low > high */
+static void limit_range(int* low_ptr, int* high_ptr)
+{
+	if (*low_ptr < 0)
+	{
+		*low_ptr = 0;
+	}
+	if (*high_ptr > RATING_LIMIT)
+	{
+		*high_ptr = RATING_LIMIT;
+	}
+}
@@ -0,0 +1,43 @@
+#ifndef RATING_INDEX_H
+#define RATING_INDEX_H
+
+/*
+A Rating_index is an opaque type that keeps the records in order of rating and then ID,
+so that the highest rated records, or those with ratings in a range, can be found without 
+looking at every record. There is an array of records in ID order for each rating,
+so finding the records for a query takes time proportional to the number found.
+
+The index does not own the records. A record's rating must not be changed while it is
+in the index; remove it, change the rating, and add it again.
+*/
+
+/* incomplete declarations */
+struct Rating_index;
+struct Record;
+
+/* type of a function applied to records found in the index */
+typedef void (*Rating_index_apply_fp_t) (void* data_ptr);
+
+/* Create an empty Rating_index object. */
+struct Rating_index* create_Rating_index(void);
+
+/* Destroy a Rating_index object; the records are not destroyed. */
+void destroy_Rating_index(struct Rating_index* index_ptr);
+
+/* Add a record to the index under its current rating. */
+void add_Rating_index_record(struct Rating_index* index_ptr, struct Record* record_ptr);
+
+/* Remove a record from the index; it must have the rating it was added with. */
+void remove_Rating_index_record(struct Rating_index* index_ptr, struct Record* record_ptr);
+
+/* Remove all records from the index. */
+void clear_Rating_index(struct Rating_index* index_ptr);
+
+/* Return the number of records with ratings from low to high, inclusive. */
+int get_Rating_index_count(const struct Rating_index* index_ptr, int low, int high);
+
+/* Apply the function to at most count records with ratings from low to high, inclusive,
+highest rating first and in ID order for equal ratings. */
+void apply_Rating_index(const struct Rating_index* index_ptr, int low, int high, int count, Rating_index_apply_fp_t func_ptr);
+
+#endif
@@ -1,32 +1,73 @@
 #include "Record.h"
 #include "Utility.h"
+#include "Lexer.h"
+#include "Output.h"
 #include "p1_globals.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
+#include <pthread.h>
 
-/* a Record contains an int ID, rating, and pointers to C-strings for the title and medium */
+/* the unit in which titles are compared, and the size of the blocks they are padded to,
+which is a whole number of words and the width of a vector register */
+#define TITLE_WORD_SIZE sizeof(unsigned long)
+#define TITLE_BLOCK_SIZE 16
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define COMPARE_INSTRUCTIONS
+#include <emmintrin.h>
+#endif
+
+/* a Record contains an int ID, rating, and pointers to C-strings for the title and medium.
+The C-strings are stored in the same allocation, directly after the struct, so that
+creating or restoring a Record costs a single allocation. The title comes first and is
+followed by zero bytes up to a whole number of blocks, whose count is kept, so that two titles
+can be compared a block or a word at a time. The array of the Collections it is a member of is only
+allocated while it is a member of any. */
 struct Record {
 	char* title;
-	int ID;
 	char* medium;
+	struct Collection** memberships;
+	int ID;
 	int rating;
+	int title_blocks;
+	int membership_count;
 };
 
 static int next_record_id;		/* next record id to be assigned */
+static pthread_once_t compare_once = PTHREAD_ONCE_INIT;
+#ifdef COMPARE_INSTRUCTIONS
+static int use_vectors;	/* non-zero if the processor has the SSE2 instructions */
+#endif
+
+/* Find whether the processor has the SSE2 instructions */
+static void choose_compare(void);
+
+#ifdef COMPARE_INSTRUCTIONS
+/* Compare two titles of the given number of blocks with the SSE2 instructions, like strcmp */
+static int vector_compare_titles(const char* first, const char* second, int blocks) __attribute__((target("sse2")));
+#endif
 
 /* Create a Record object, giving it the next ID number using the ID number counter.
 The function that allocates dynamic memory for a Record and the contained data. The rating is set to 0. */
 struct Record* create_Record(const char* medium, const char* title)
 {
-	struct Record *record = malloc(sizeof(struct Record));
 	int medium_len = strlen(medium) + 1;
 	int title_len = strlen(title) + 1;
+	int title_blocks = (title_len + TITLE_BLOCK_SIZE - 1) / TITLE_BLOCK_SIZE;
+	struct Record *record = malloc(sizeof(struct Record) + title_blocks * TITLE_BLOCK_SIZE + medium_len);
+	/* titles are only compared once a Record exists, so the comparison is chosen here */
+	pthread_once(&compare_once, choose_compare);
 	g_string_memory += medium_len + title_len;
-	record->medium = strcpy(malloc(medium_len), medium);
-	record->title = strcpy(malloc(title_len), title);
+	record->title = (char *)(record + 1);
+	memset(record->title, 0, title_blocks * TITLE_BLOCK_SIZE);
+	strcpy(record->title, title);
+	record->title_blocks = title_blocks;
+	record->medium = strcpy(record->title + title_blocks * TITLE_BLOCK_SIZE, medium);
 	record->rating = 0;
+	record->memberships = NULL;
+	record->membership_count = 0;
 	record->ID = ++next_record_id;
 	return record;
 }
@@ -38,8 +79,8 @@ void destroy_Record(struct Record* record_ptr)
 {
 	g_string_memory -= strlen(record_ptr->title) + 1;
 	g_string_memory -= strlen(record_ptr->medium) + 1;
-	free(record_ptr->title);
-	free(record_ptr->medium);
+	/* the C-strings share the Record's allocation */
+	free(record_ptr->memberships);
 	free(record_ptr);
 }
 
@@ -57,26 +98,115 @@ const char* get_Record_title(const struct Record* record_ptr)
 	return record_ptr->title;
 }
 
+/* Get the medium pointer. */
+const char* get_Record_medium(const struct Record* record_ptr)
+{
+	return record_ptr->medium;
+}
+
+/* Compare the titles of two Records, like strcmp. */
+int compare_Record_titles(const struct Record* first_record_ptr, const struct Record* second_record_ptr)
+{
+	const char *first = first_record_ptr->title;
+	const char *second = second_record_ptr->title;
+	int blocks = first_record_ptr->title_blocks < second_record_ptr->title_blocks ?
+		first_record_ptr->title_blocks : second_record_ptr->title_blocks;
+	int words = blocks * (TITLE_BLOCK_SIZE / TITLE_WORD_SIZE);
+	int i;
+#ifdef COMPARE_INSTRUCTIONS
+	if (use_vectors)
+	{
+		return vector_compare_titles(first, second, blocks);
+	}
+#endif
+	/* the end of the shorter title is in its last word, and the zero bytes after it are
+	compared like the terminating null; if every word is equal the titles are too */
+	for (i = 0; i < words; i++, first += TITLE_WORD_SIZE, second += TITLE_WORD_SIZE)
+	{
+		unsigned long first_word, second_word;
+		memcpy(&first_word, first, TITLE_WORD_SIZE);
+		memcpy(&second_word, second, TITLE_WORD_SIZE);
+		if (first_word != second_word)
+		{
+			while (*first == *second)
+			{
+				first++;
+				second++;
+			}
+			return (unsigned char)*first - (unsigned char)*second;
+		}
+	}
+	return 0;
+}
+
+/* Return the rating; zero if the Record has not been rated. */
+int get_Record_rating(const struct Record* record_ptr)
+{
+	return record_ptr->rating;
+}
+
 /* Set the rating. */
 void set_Record_rating(struct Record* record_ptr, int new_rating)
 {
 	record_ptr->rating = new_rating;
 }
 
+/* Link the Record to a Collection it has been added to. */
+void add_Record_membership(struct Record* record_ptr, struct Collection* collection_ptr)
+{
+	/* a Record is in few Collections, and joins them rarely, so the array is kept exactly full */
+	record_ptr->memberships = realloc(record_ptr->memberships, (record_ptr->membership_count + 1) * sizeof(struct Collection *));
+	record_ptr->memberships[record_ptr->membership_count++] = collection_ptr;
+}
+
+/* Remove the link from the Record to a Collection it has been removed from. */
+void remove_Record_membership(struct Record* record_ptr, struct Collection* collection_ptr)
+{
+	int i;
+	for (i = 0; i < record_ptr->membership_count; i++)
+	{
+		if (record_ptr->memberships[i] == collection_ptr)
+		{
+			/* the order of the Collections does not matter, so the last one takes its place */
+			record_ptr->memberships[i] = record_ptr->memberships[--record_ptr->membership_count];
+			break;
+		}
+	}
+	if (record_ptr->membership_count == 0)
+	{
+		free(record_ptr->memberships);
+		record_ptr->memberships = NULL;
+	}
+}
+
+/* Return the number of Collections the Record is a member of, and set collections_ptr
+to point to the array of them. */
+int get_Record_memberships(const struct Record* record_ptr, struct Collection* const** collections_ptr)
+{
+	*collections_ptr = record_ptr->memberships;
+	return record_ptr->membership_count;
+}
+
 /* Print a Record data items to standard output with a final \n character.
 Output order is ID number followed by a ':' then medium, rating, title, separated by one space.
 If the rating is zero, a 'u' is printed instead of the rating. */
 void print_Record(const struct Record* record_ptr)
 {
-	struct Record record = *record_ptr;
-	if (record.rating == 0)
+	output_int(record_ptr->ID);
+	output_string(": ");
+	output_string(record_ptr->medium);
+	output_char(' ');
+	if (record_ptr->rating == 0)
 	{
-			printf("%d: %s u %s\n", record.ID, record.medium, record.title);
+		output_char('u');
 	}
 	else
 	{
-			printf("%d: %s %d %s\n", record.ID, record.medium, record.rating, record.title);
+		output_int(record_ptr->rating);
 	}
+	output_char(' ');
+	output_string(record_ptr->title);
+	output_char('\n');
 }
 
 /* Write a Record to a file stream with a final \n character.
@@ -87,44 +217,51 @@ void save_Record(const struct Record* record_ptr, FILE* outfile)
 	fprintf(outfile, "%d %s %d %s\n", record.ID, record.medium, record.rating, record.title);
 }
 
-/* Read a Record's data from a file stream, create the data object and
+/* Read a Record's data from a file stream's Lexer, create the data object and
 return a pointer to it, NULL if invalid data discovered in file.
 No check made in this function for whether the Record already exists or not.
 The counter for the next ID number is set to the largest value found. */
-struct Record* load_Record(FILE* infile)
+struct Record* load_Record(struct Lexer* input)
 {
-	struct Record *record;
 	int id, rating;
 	char medium[MEDIUM_BUFFER_SIZE];
 	char title[TITLE_BUFFER_SIZE];
 	char *title_start;
-	if (fscanf(infile, "%d", &id) != 1)
+	if (!lex_int(input, &id))
 	{
 		/* ID error */
 		return NULL;
 	}
-	if (fscanf(infile, MEDIUM_SCAN_BUFFER, medium) != 1)
+	if (!lex_word(input, medium, MEDIUM_BUFFER_SIZE))
 	{
 		/* medium error */
 		return NULL;
 	}
-	if (fscanf(infile, "%d ", &rating) != 1 || rating < 0 || rating > 10)
+	if (!lex_int(input, &rating) || rating < 0 || rating > 10)
 	{
 		/* rating error */
 		return NULL;
 	}
-	title_start = read_title(title, infile);
+	lex_skip_whitespace(input);
+	title_start = read_title(title, input);
 	if (!title_start)
 	{
 		/* title error */
 		return NULL;
 	}
-	record = create_Record(medium, title_start);
+	return restore_Record(id, medium, rating, title_start);
+}
+
+/* Create a Record object with the ID number and rating it was saved with, as load_Record does
+once it has read them. The counter for the next ID number is set to the largest value found. */
+struct Record* restore_Record(int ID, const char* medium, int rating, const char* title)
+{
+	struct Record *record = create_Record(medium, title);
 	next_record_id--; /* counteract the increment of create_Record */
-	record->ID = id;
-	if (id > next_record_id)
+	record->ID = ID;
+	if (ID > next_record_id)
 	{
-		next_record_id = id;
+		next_record_id = ID;
 	}
 	record->rating = rating;
 	return record;
@@ -134,4 +271,35 @@ struct Record* load_Record(FILE* infile)
 void reset_Record_ID_counter(void)
 {
 	next_record_id = 0;
-}
\ No newline at end of file
+}
+
+/* Find whether the processor has the SSE2 instructions */
+static void choose_compare(void)
+{
+#ifdef COMPARE_INSTRUCTIONS
+	__builtin_cpu_init();
+	use_vectors = __builtin_cpu_supports("sse2");
+#endif
+}
+
+#ifdef COMPARE_INSTRUCTIONS
+/* Compare two titles of the given number of blocks with the SSE2 instructions, like strcmp:
+each block is compared at once, and the first differing byte is found from the mask of the
+bytes that are equal */
+static int vector_compare_titles(const char* first, const char* second, int blocks)
+{
+	int i;
+	for (i = 0; i < blocks; i++, first += TITLE_BLOCK_SIZE, second += TITLE_BLOCK_SIZE)
+	{
+		__m128i first_block = _mm_loadu_si128((const __m128i *)first);
+		__m128i second_block = _mm_loadu_si128((const __m128i *)second);
+		unsigned int equal = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(first_block, second_block));
+		if (equal != 0xffff)
+		{
+			int position = __builtin_ctz(~equal);
+			return (unsigned char)first[position] - (unsigned char)second[position];
+		}
+	}
+	return 0;
+}
+#endif
@@ -4,12 +4,16 @@
 /* 
 A Record is an opaque type containing a unique ID number, a rating, and a title
 and medium name as pointers to C-strings that are stored in dynamically allocated memory.
+A Record is also linked to the Collections it is a member of, so that a change to the
+Record can be passed on to them.
 */
 
 #include <stdio.h> /* for the declaration of FILE */
 
-/* incomplete declaration */
+/* incomplete declarations */
 struct Record;
+struct Collection;
+struct Lexer;
 
 /* Create a Record object, giving it the next ID number using the ID number counter. 
 The function that allocates dynamic memory for a Record and the contained data. The rating is set to 0. */
@@ -28,9 +32,28 @@ int get_Record_ID(const struct Record* record_ptr);
 /* Get the title pointer. */
 const char* get_Record_title(const struct Record* record_ptr);
 
+/* Get the medium pointer. */
+const char* get_Record_medium(const struct Record* record_ptr);
+
+/* Compare the titles of two Records, like strcmp. */
+int compare_Record_titles(const struct Record* first_record_ptr, const struct Record* second_record_ptr);
+
+/* Return the rating; zero if the Record has not been rated. */
+int get_Record_rating(const struct Record* record_ptr);
+
 /* Set the rating. */
 void set_Record_rating(struct Record* record_ptr, int new_rating);
 
+/* Link the Record to a Collection it has been added to. */
+void add_Record_membership(struct Record* record_ptr, struct Collection* collection_ptr);
+
+/* Remove the link from the Record to a Collection it has been removed from. */
+void remove_Record_membership(struct Record* record_ptr, struct Collection* collection_ptr);
+
+/* Return the number of Collections the Record is a member of, and set collections_ptr
+to point to the array of them. */
+int get_Record_memberships(const struct Record* record_ptr, struct Collection* const** collections_ptr);
+
 /* Print a Record data items to standard output with a final \n character. 
 Output order is ID number followed by a ':' then medium, rating, title, separated by one space.
 If the rating is zero, a 'u' is printed instead of the rating. */
@@ -40,11 +63,15 @@ void print_Record(const struct Record* record_ptr);
 Output order is ID number, medium, rating, title */
 void save_Record(const struct Record* record_ptr, FILE* outfile);
 
-/* Read a Record's data from a file stream, create the data object and 
+/* Read a Record's data from a file stream's Lexer, create the data object and 
 return a pointer to it, NULL if invalid data discovered in file.
 No check made in this function for whether the Record already exists or not. 
 The counter for the next ID number is set to the largest value found. */
-struct Record* load_Record(FILE* infile);
+struct Record* load_Record(struct Lexer* input);
+
+/* Create a Record object with the ID number and rating it was saved with, as load_Record does
+once it has read them. The counter for the next ID number is set to the largest value found. */
+struct Record* restore_Record(int ID, const char* medium, int rating, const char* title);
 
 /* Reset the counter for the next ID number to zero.  */
 void reset_Record_ID_counter(void);
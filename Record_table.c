@@ -0,0 +1,407 @@
+#include "Record_table.h"
+#include "Record.h"
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+
+#define NO_MEDIUM -1
+#define OTHER_MEDIUM 255	/* the code shared by every medium after the first OTHER_MEDIUM */
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define SCAN_INSTRUCTIONS
+#include <immintrin.h>
+#define VECTOR_BYTES 32
+#endif
+
+/* a Record_table contains an array for each field in ID order, all with the same size
+and allocation, and the names of the media, each at the position of its code; the
+codes are bytes, so that a vector register holds the codes of many records */
+struct Record_table {
+	int* IDs;
+	unsigned char* ratings;
+	unsigned char* media;
+	struct Record** records;
+	int size;
+	int allocation;
+	char** medium_names;
+	int medium_count;
+};
+
+static pthread_once_t scan_once = PTHREAD_ONCE_INIT;
+#ifdef SCAN_INSTRUCTIONS
+static int use_vectors;	/* non-zero if the processor has the AVX2 instructions */
+#endif
+
+/* Return the position of the first record in the table whose ID is not less than the given ID */
+static int table_lower_bound(const struct Record_table* table_ptr, int ID);
+
+/* Find whether the processor has the AVX2 instructions */
+static void choose_scan(void);
+
+/* Return the number of values that are at least the minimum */
+static int count_at_least(const unsigned char* values, int size, unsigned char minimum);
+
+/* Return the number of values equal to the value */
+static int count_equal(const unsigned char* values, int size, unsigned char value);
+
+/* Copy the records whose values are equal to the value to the results, of which there are count */
+static void select_equal(const unsigned char* values, struct Record* const* records, int size, unsigned char value,
+	struct Record** results, int count);
+
+#ifdef SCAN_INSTRUCTIONS
+/* The same scans with the AVX2 instructions, comparing VECTOR_BYTES values at a time */
+static int vector_count_at_least(const unsigned char* values, int size, unsigned char minimum) __attribute__((target("avx2,popcnt")));
+static int vector_count_equal(const unsigned char* values, int size, unsigned char value) __attribute__((target("avx2,popcnt")));
+static void vector_select_equal(const unsigned char* values, struct Record* const* records, int size, unsigned char value,
+	struct Record** results, int count) __attribute__((target("avx2,popcnt")));
+#endif
+
+/* Return the code for the medium, or NO_MEDIUM if no record has had it; OTHER_MEDIUM is
+returned for a medium without a code of its own once every code is used */
+static int find_medium_code(const struct Record_table* table_ptr, const char* medium);
+
+/* Return the code for the medium, giving it a new one if it does not have one and
+one is left, and otherwise OTHER_MEDIUM */
+static int add_medium_code(struct Record_table* table_ptr, const char* medium);
+
+/* Move the fields of the records from the position on by the given number of places */
+static void move_fields(struct Record_table* table_ptr, int position, int places);
+
+/* Create an empty Record_table object. */
+struct Record_table* create_Record_table(void)
+{
+	struct Record_table *table = malloc(sizeof(struct Record_table));
+	table->IDs = NULL;
+	table->ratings = NULL;
+	table->media = NULL;
+	table->records = NULL;
+	table->size = 0;
+	table->allocation = 0;
+	table->medium_names = NULL;
+	table->medium_count = 0;
+	return table;
+}
+
+/* Destroy a Record_table object; the records are not destroyed. */
+void destroy_Record_table(struct Record_table* table_ptr)
+{
+	clear_Record_table(table_ptr);
+	free(table_ptr->IDs);
+	free(table_ptr->ratings);
+	free(table_ptr->media);
+	free(table_ptr->records);
+	free(table_ptr);
+}
+
+/* Add a record to the table. */
+void add_Record_table_record(struct Record_table* table_ptr, struct Record* record_ptr)
+{
+	int ID = get_Record_ID(record_ptr);
+	int position;
+	if (table_ptr->size == table_ptr->allocation)
+	{
+		table_ptr->allocation = table_ptr->allocation * 2 + 1;
+		table_ptr->IDs = realloc(table_ptr->IDs, table_ptr->allocation * sizeof(int));
+		table_ptr->ratings = realloc(table_ptr->ratings, table_ptr->allocation);
+		table_ptr->media = realloc(table_ptr->media, table_ptr->allocation);
+		table_ptr->records = realloc(table_ptr->records, table_ptr->allocation * sizeof(struct Record *));
+	}
+	/* new records have the largest ID, so this is usually the end of the table */
+	if (table_ptr->size == 0 || table_ptr->IDs[table_ptr->size - 1] < ID)
+	{
+		position = table_ptr->size;
+	}
+	else
+	{
+		position = table_lower_bound(table_ptr, ID);
+		move_fields(table_ptr, position, 1);
+	}
+	table_ptr->IDs[position] = ID;
+	table_ptr->ratings[position] = (unsigned char)get_Record_rating(record_ptr);
+	table_ptr->media[position] = (unsigned char)add_medium_code(table_ptr, get_Record_medium(record_ptr));
+	table_ptr->records[position] = record_ptr;
+	table_ptr->size++;
+}
+
+/* Remove a record from the table. */
+void remove_Record_table_record(struct Record_table* table_ptr, struct Record* record_ptr)
+{
+	int position = table_lower_bound(table_ptr, get_Record_ID(record_ptr));
+	if (position < table_ptr->size && table_ptr->records[position] == record_ptr)
+	{
+		move_fields(table_ptr, position + 1, -1);
+		table_ptr->size--;
+	}
+}
+
+/* Copy the rating of a record in the table from the record, once it has changed. */
+void rate_Record_table_record(struct Record_table* table_ptr, const struct Record* record_ptr)
+{
+	int position = table_lower_bound(table_ptr, get_Record_ID(record_ptr));
+	if (position < table_ptr->size && table_ptr->records[position] == record_ptr)
+	{
+		table_ptr->ratings[position] = (unsigned char)get_Record_rating(record_ptr);
+	}
+}
+
+/* Remove all records from the table. */
+void clear_Record_table(struct Record_table* table_ptr)
+{
+	int i;
+	for (i = 0; i < table_ptr->medium_count; i++)
+	{
+		free(table_ptr->medium_names[i]);
+	}
+	free(table_ptr->medium_names);
+	table_ptr->medium_names = NULL;
+	table_ptr->medium_count = 0;
+	table_ptr->size = 0;
+}
+
+/* Return the number of records with a rating of at least the given one. */
+int count_Record_table_rated(const struct Record_table* table_ptr, int rating)
+{
+	if (rating <= 0)
+	{
+		return table_ptr->size;
+	}
+	if (rating > UCHAR_MAX)
+	{
+		return 0;
+	}
+	pthread_once(&scan_once, choose_scan);
+#ifdef SCAN_INSTRUCTIONS
+	if (use_vectors)
+	{
+		return vector_count_at_least(table_ptr->ratings, table_ptr->size, (unsigned char)rating);
+	}
+#endif
+	return count_at_least(table_ptr->ratings, table_ptr->size, (unsigned char)rating);
+}
+
+/* Return the number of records with the medium. */
+int count_Record_table_medium(const struct Record_table* table_ptr, const char* medium)
+{
+	int code = find_medium_code(table_ptr, medium);
+	int count = 0;
+	int i;
+	if (code == NO_MEDIUM)
+	{
+		return 0;
+	}
+	if (code == OTHER_MEDIUM)
+	{
+		/* the records with the shared code are told apart by the names of their media */
+		for (i = 0; i < table_ptr->size; i++)
+		{
+			count += table_ptr->media[i] == OTHER_MEDIUM && !strcmp(get_Record_medium(table_ptr->records[i]), medium);
+		}
+		return count;
+	}
+	pthread_once(&scan_once, choose_scan);
+#ifdef SCAN_INSTRUCTIONS
+	if (use_vectors)
+	{
+		return vector_count_equal(table_ptr->media, table_ptr->size, (unsigned char)code);
+	}
+#endif
+	return count_equal(table_ptr->media, table_ptr->size, (unsigned char)code);
+}
+
+/* Find the records with the medium. Returns an array of them in ID order, which the caller
+must free, and sets count_ptr to the number of records in it. */
+struct Record** search_Record_table_medium(const struct Record_table* table_ptr, const char* medium, int* count_ptr)
+{
+	struct Record **results;
+	int count = count_Record_table_medium(table_ptr, medium);
+	int code = find_medium_code(table_ptr, medium);
+	int found = 0;
+	int i;
+	results = malloc((count > 0 ? count : 1) * sizeof(struct Record *));
+	*count_ptr = count;
+	if (count == 0)
+	{
+		return results;
+	}
+	if (code == OTHER_MEDIUM)
+	{
+		for (i = 0; found < count; i++)
+		{
+			if (table_ptr->media[i] == OTHER_MEDIUM && !strcmp(get_Record_medium(table_ptr->records[i]), medium))
+			{
+				results[found++] = table_ptr->records[i];
+			}
+		}
+		return results;
+	}
+#ifdef SCAN_INSTRUCTIONS
+	if (use_vectors)
+	{
+		vector_select_equal(table_ptr->media, table_ptr->records, table_ptr->size, (unsigned char)code, results, count);
+		return results;
+	}
+#endif
+	select_equal(table_ptr->media, table_ptr->records, table_ptr->size, (unsigned char)code, results, count);
+	return results;
+}
+
+/* Return the position of the first record in the table whose ID is not less than the given ID */
+static int table_lower_bound(const struct Record_table* table_ptr, int ID)
+{
+	int low = 0;
+	int high = table_ptr->size;
+	while (low < high)
+	{
+		int middle = low + (high - low) / 2;
+		if (table_ptr->IDs[middle] < ID)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return low;
+}
+
+/* Return the code for the medium, or NO_MEDIUM if no record has had it; OTHER_MEDIUM is
+returned for a medium without a code of its own once every code is used */
+static int find_medium_code(const struct Record_table* table_ptr, const char* medium)
+{
+	int i;
+	for (i = 0; i < table_ptr->medium_count; i++)
+	{
+		if (!strcmp(table_ptr->medium_names[i], medium))
+		{
+			return i;
+		}
+	}
+	return table_ptr->medium_count == OTHER_MEDIUM ? OTHER_MEDIUM : NO_MEDIUM;
+}
+
+/* Return the code for the medium, giving it a new one if it does not have one and
+one is left, and otherwise OTHER_MEDIUM */
+static int add_medium_code(struct Record_table* table_ptr, const char* medium)
+{
+	int code = find_medium_code(table_ptr, medium);
+	if (code != NO_MEDIUM)
+	{
+		return code;
+	}
+	table_ptr->medium_names = realloc(table_ptr->medium_names, (table_ptr->medium_count + 1) * sizeof(char *));
+	table_ptr->medium_names[table_ptr->medium_count] = strcpy(malloc(strlen(medium) + 1), medium);
+	return table_ptr->medium_count++;
+}
+
+/* Move the fields of the records from the position on by the given number of places */
+static void move_fields(struct Record_table* table_ptr, int position, int places)
+{
+	int moved = table_ptr->size - position;
+	memmove(table_ptr->IDs + position + places, table_ptr->IDs + position, moved * sizeof(int));
+	memmove(table_ptr->ratings + position + places, table_ptr->ratings + position, moved);
+	memmove(table_ptr->media + position + places, table_ptr->media + position, moved);
+	memmove(table_ptr->records + position + places, table_ptr->records + position, moved * sizeof(struct Record *));
+}
+
+/* Find whether the processor has the AVX2 instructions */
+static void choose_scan(void)
+{
+#ifdef SCAN_INSTRUCTIONS
+	__builtin_cpu_init();
+	use_vectors = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#endif
+}
+
+/* Return the number of values that are at least the minimum */
+static int count_at_least(const unsigned char* values, int size, unsigned char minimum)
+{
+	int count = 0;
+	int i;
+	/* adding the result of each comparison keeps the loop free of branches */
+	for (i = 0; i < size; i++)
+	{
+		count += values[i] >= minimum;
+	}
+	return count;
+}
+
+/* Return the number of values equal to the value */
+static int count_equal(const unsigned char* values, int size, unsigned char value)
+{
+	int count = 0;
+	int i;
+	for (i = 0; i < size; i++)
+	{
+		count += values[i] == value;
+	}
+	return count;
+}
+
+/* Copy the records whose values are equal to the value to the results, of which there are count */
+static void select_equal(const unsigned char* values, struct Record* const* records, int size, unsigned char value,
+	struct Record** results, int count)
+{
+	int found = 0;
+	int i;
+	/* every record is written to the next place in the results, which only moves on for a match */
+	for (i = 0; i < size && found < count; i++)
+	{
+		results[found] = records[i];
+		found += values[i] == value;
+	}
+}
+
+#ifdef SCAN_INSTRUCTIONS
+/* The same scans with the AVX2 instructions, comparing VECTOR_BYTES values at a time: a comparison
+gives a byte of ones for each match, and movemask gathers the bytes into the bits of an int.
+The values after the last whole vector are left to the scalar scans. */
+static int vector_count_at_least(const unsigned char* values, int size, unsigned char minimum)
+{
+	__m256i minimums = _mm256_set1_epi8((char)minimum);
+	int count = 0;
+	int i;
+	for (i = 0; i + VECTOR_BYTES <= size; i += VECTOR_BYTES)
+	{
+		__m256i block = _mm256_loadu_si256((const __m256i *)(values + i));
+		/* there is no unsigned byte comparison, but a value is at least the minimum if it is their maximum */
+		__m256i matches = _mm256_cmpeq_epi8(_mm256_max_epu8(block, minimums), block);
+		count += __builtin_popcount((unsigned int)_mm256_movemask_epi8(matches));
+	}
+	return count + count_at_least(values + i, size - i, minimum);
+}
+
+static int vector_count_equal(const unsigned char* values, int size, unsigned char value)
+{
+	__m256i keys = _mm256_set1_epi8((char)value);
+	int count = 0;
+	int i;
+	for (i = 0; i + VECTOR_BYTES <= size; i += VECTOR_BYTES)
+	{
+		__m256i block = _mm256_loadu_si256((const __m256i *)(values + i));
+		count += __builtin_popcount((unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, keys)));
+	}
+	return count + count_equal(values + i, size - i, value);
+}
+
+static void vector_select_equal(const unsigned char* values, struct Record* const* records, int size, unsigned char value,
+	struct Record** results, int count)
+{
+	__m256i keys = _mm256_set1_epi8((char)value);
+	int found = 0;
+	int i;
+	for (i = 0; i + VECTOR_BYTES <= size && found < count; i += VECTOR_BYTES)
+	{
+		__m256i block = _mm256_loadu_si256((const __m256i *)(values + i));
+		unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, keys));
+		/* each set bit is a match, taken lowest first so that the results stay in ID order */
+		while (mask)
+		{
+			results[found++] = records[i + __builtin_ctz(mask)];
+			mask &= mask - 1;
+		}
+	}
+	select_equal(values + i, records + i, size - i, value, results + found, count - found);
+}
+#endif
@@ -0,0 +1,49 @@
+#ifndef RECORD_TABLE_H
+#define RECORD_TABLE_H
+
+/*
+A Record_table is an opaque type that keeps the fields of the records that scans look at
+in separate arrays, one per field, in ID order: the ID, the rating, and a code for the medium.
+Counting or finding the records that match a rating or a medium reads only the array for
+that field, one byte per record, instead of following a pointer to every record. Where the
+processor has the AVX2 instructions, the scans compare 32 of these bytes at a time.
+The records themselves are kept in another array in the same order, so each match found
+is still returned as a Record.
+
+The table does not own the records. When a record's rating changes, the table must be
+told with rate_Record_table_record, which rewrites the rating in place.
+*/
+
+/* incomplete declarations */
+struct Record_table;
+struct Record;
+
+/* Create an empty Record_table object. */
+struct Record_table* create_Record_table(void);
+
+/* Destroy a Record_table object; the records are not destroyed. */
+void destroy_Record_table(struct Record_table* table_ptr);
+
+/* Add a record to the table. */
+void add_Record_table_record(struct Record_table* table_ptr, struct Record* record_ptr);
+
+/* Remove a record from the table. */
+void remove_Record_table_record(struct Record_table* table_ptr, struct Record* record_ptr);
+
+/* Copy the rating of a record in the table from the record, once it has changed. */
+void rate_Record_table_record(struct Record_table* table_ptr, const struct Record* record_ptr);
+
+/* Remove all records from the table. */
+void clear_Record_table(struct Record_table* table_ptr);
+
+/* Return the number of records with a rating of at least the given one. */
+int count_Record_table_rated(const struct Record_table* table_ptr, int rating);
+
+/* Return the number of records with the medium. */
+int count_Record_table_medium(const struct Record_table* table_ptr, const char* medium);
+
+/* Find the records with the medium. Returns an array of them in ID order, which the caller
+must free, and sets count_ptr to the number of records in it. */
+struct Record** search_Record_table_medium(const struct Record_table* table_ptr, const char* medium, int* count_ptr);
+
+#endif
@@ -0,0 +1,183 @@
+#define _POSIX_C_SOURCE 200112L
+#include "Server.h"
+#include "Lexer.h"
+#include "Output.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define SERVER_BACKLOG 64
+
+/* what every session needs to run commands against the shared data */
+struct Server {
+	void* data_ptr;
+	Server_command_fp_t command_func;
+	Server_read_only_fp_t read_only_func;
+	pthread_rwlock_t data_lock;		/* held for reading or writing while a command runs */
+};
+
+/* one connected client */
+struct Session {
+	struct Server* server;
+	int socket_fd;
+};
+
+/* Open a listening socket at the path; returns -1 on failure */
+static int open_server_socket(const char* socket_path);
+
+/* Thread function that runs the commands of one client until it quits or disconnects */
+static void* serve_session(void* session_ptr);
+
+/* Serve clients on a socket at the given path, running their commands with command_func
+against the data. Returns non-zero if the socket could not be set up; otherwise the server
+runs until the process is killed. */
+int run_server(const char* socket_path, void* data_ptr, Server_command_fp_t command_func, Server_read_only_fp_t read_only_func)
+{
+	struct Server server;
+	int listen_fd = open_server_socket(socket_path);
+	if (listen_fd < 0)
+	{
+		return 1;
+	}
+	/* a client that disconnects before reading its answers must not end the server */
+	signal(SIGPIPE, SIG_IGN);
+	server.data_ptr = data_ptr;
+	server.command_func = command_func;
+	server.read_only_func = read_only_func;
+	pthread_rwlock_init(&server.data_lock, NULL);
+	while (1)
+	{
+		pthread_t thread;
+		struct Session *session;
+		int client_fd = accept(listen_fd, NULL, NULL);
+		if (client_fd < 0)
+		{
+			continue;
+		}
+		session = malloc(sizeof(struct Session));
+		session->server = &server;
+		session->socket_fd = client_fd;
+		if (pthread_create(&thread, NULL, serve_session, session) != 0)
+		{
+			close(client_fd);
+			free(session);
+			continue;
+		}
+		pthread_detach(thread);
+	}
+}
+
+/* Open a listening socket at the path; returns -1 on failure */
+static int open_server_socket(const char* socket_path)
+{
+	struct sockaddr_un address;
+	int listen_fd;
+	if (strlen(socket_path) >= sizeof(address.sun_path))
+	{
+		return -1;
+	}
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socket_path);
+	listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listen_fd < 0)
+	{
+		return -1;
+	}
+	/* remove a socket left behind by an earlier server */
+	unlink(socket_path);
+	if (bind(listen_fd, (struct sockaddr *)&address, sizeof(address)) < 0 || listen(listen_fd, SERVER_BACKLOG) < 0)
+	{
+		close(listen_fd);
+		return -1;
+	}
+	return listen_fd;
+}
+
+/* Thread function that runs the commands of one client until it quits or disconnects */
+static void* serve_session(void* session_ptr)
+{
+	struct Session *session = session_ptr;
+	struct Server *server = session->server;
+	FILE *from_client = fdopen(session->socket_fd, "r");
+	FILE *to_client = from_client ? fdopen(dup(session->socket_fd), "w") : NULL;
+	struct Lexer *input;
+	struct Lexer *command_input;
+	struct Output *output;
+	int running = 1;
+	char action, object;
+	if (!to_client)
+	{
+		if (from_client)
+		{
+			fclose(from_client);
+		}
+		else
+		{
+			close(session->socket_fd);
+		}
+		free(session);
+		return NULL;
+	}
+	free(session);
+	input = create_Lexer(from_client, 1);
+	command_input = create_Lexer(NULL, 0);
+	output = create_Output(to_client);
+	set_current_Output(output);
+	/* the answer to a command is only written after the lock is released */
+	hold_output(1);
+	while (running)
+	{
+		output_string("\nEnter command: ");
+		output_flush();
+		/* the whole line is read before the lock is taken, so that a client 
+		that stops partway through a command does not hold up the others */
+		while (running && lex_peek_char(command_input) == EOF)
+		{
+			running = lex_take_line(command_input, input);
+		}
+		if (!running)
+		{
+			/* the client disconnected */
+			break;
+		}
+		lex_char(command_input, &action);
+		if (!lex_char(command_input, &object))
+		{
+			/* not a command, which the command function reports */
+			object = '\n';
+		}
+		if (server->read_only_func(action, object))
+		{
+			pthread_rwlock_rdlock(&server->data_lock);
+		}
+		else
+		{
+			pthread_rwlock_wrlock(&server->data_lock);
+		}
+		if (server->command_func(server->data_ptr, command_input, action, object))
+		{
+			output_string("Done\n");
+			running = 0;
+		}
+		pthread_rwlock_unlock(&server->data_lock);
+		if (lex_ran_out(command_input))
+		{
+			/* the command wanted more than its line, which is not waited for with the lock held */
+			output_string("A command and its arguments must be on one line!\n");
+		}
+	}
+	hold_output(0);
+	set_current_Output(NULL);
+	destroy_Output(output);
+	destroy_Lexer(command_input);
+	destroy_Lexer(input);
+	fclose(to_client);
+	fclose(from_client);
+	return NULL;
+}
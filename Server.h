@@ -0,0 +1,34 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+/* 
+The server runs the command interpreter for many clients at once on a Unix domain socket,
+so that the data stays in memory between sessions. Each connection is served by its own 
+thread with its own Lexer and Output, so a client may send many commands without waiting,
+and the answers come back in order, each followed by the usual prompt.
+
+All clients share one set of data, protected by a readers-writer lock: commands that only 
+read the data run in parallel, and a command that changes it runs alone. A command must be 
+on one line, which is read in full before the lock is taken, and its answer is only written
+to the client after the lock is released, so the lock is never held while a client is being
+waited for. Unlike at the console, the arguments of a command are not looked for on the
+following lines: a command that runs out of arguments fails, and the client is told that
+the command must be on one line.
+*/
+
+/* incomplete declaration */
+struct Lexer;
+
+/* Reads the rest of a command from the input and runs it against the shared data;
+returns non-zero if the command ends the client's session. */
+typedef int (*Server_command_fp_t) (void* data_ptr, struct Lexer* input, char action, char object);
+
+/* Returns non-zero if the command only reads the shared data. */
+typedef int (*Server_read_only_fp_t) (char action, char object);
+
+/* Serve clients on a socket at the given path, running their commands with command_func
+against the data. Returns non-zero if the socket could not be set up; otherwise the server
+runs until the process is killed. */
+int run_server(const char* socket_path, void* data_ptr, Server_command_fp_t command_func, Server_read_only_fp_t read_only_func);
+
+#endif
@@ -0,0 +1,87 @@
+#define _POSIX_C_SOURCE 200112L
+#include "Snapshot.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+/* a Snapshot contains the child process doing the save, the file it is writing, which the
+parent keeps open to see how much has been written, and the status once the child has exited */
+struct Snapshot {
+	pid_t pid;
+	FILE* outfile;
+	int status;
+};
+
+/* Record the exit status of the child process in the Snapshot */
+static void set_exit_status(struct Snapshot* snapshot_ptr, int wait_status);
+
+/* Create a Snapshot object that saves the data to the open file with save_func in a child
+process. The file belongs to the Snapshot from then on. Returns NULL if the child process
+could not be started, in which case the file is left open. */
+struct Snapshot* create_Snapshot(FILE* outfile, Snapshot_save_fp_t save_func, void* data_ptr)
+{
+	struct Snapshot *snapshot;
+	pid_t pid;
+	/* anything buffered would otherwise be written by both processes; the child only closes
+	the file, and other streams, such as those of server clients waiting for input, are left alone
+	because flushing them would wait for the threads using them */
+	fflush(stdout);
+	fflush(outfile);
+	pid = fork();
+	if (pid < 0)
+	{
+		return NULL;
+	}
+	if (pid == 0)
+	{
+		save_func(outfile, data_ptr);
+		/* _exit so that the parent's other streams are not flushed or closed again */
+		_exit(fclose(outfile) != 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+	}
+	snapshot = malloc(sizeof(struct Snapshot));
+	snapshot->pid = pid;
+	snapshot->outfile = outfile;
+	snapshot->status = SNAPSHOT_RUNNING;
+	return snapshot;
+}
+
+/* Destroy a Snapshot object, first waiting for the save to finish if it is still running. */
+void destroy_Snapshot(struct Snapshot* snapshot_ptr)
+{
+	int wait_status;
+	if (snapshot_ptr->status == SNAPSHOT_RUNNING && waitpid(snapshot_ptr->pid, &wait_status, 0) == snapshot_ptr->pid)
+	{
+		set_exit_status(snapshot_ptr, wait_status);
+	}
+	fclose(snapshot_ptr->outfile);
+	free(snapshot_ptr);
+}
+
+/* Return the status of the save, and set bytes_written_ptr to the size of the file so far. */
+int get_Snapshot_status(struct Snapshot* snapshot_ptr, long* bytes_written_ptr)
+{
+	int wait_status;
+	struct stat file_status;
+	if (snapshot_ptr->status == SNAPSHOT_RUNNING && waitpid(snapshot_ptr->pid, &wait_status, WNOHANG) == snapshot_ptr->pid)
+	{
+		set_exit_status(snapshot_ptr, wait_status);
+	}
+	*bytes_written_ptr = fstat(fileno(snapshot_ptr->outfile), &file_status) == 0 ? (long)file_status.st_size : 0L;
+	return snapshot_ptr->status;
+}
+
+/* Record the exit status of the child process in the Snapshot */
+static void set_exit_status(struct Snapshot* snapshot_ptr, int wait_status)
+{
+	if (WIFEXITED(wait_status) && WEXITSTATUS(wait_status) == EXIT_SUCCESS)
+	{
+		snapshot_ptr->status = SNAPSHOT_COMPLETED;
+	}
+	else
+	{
+		snapshot_ptr->status = SNAPSHOT_FAILED;
+	}
+}
@@ -0,0 +1,35 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+/* 
+A Snapshot is an opaque type for a save that runs in the background. The save is done 
+by a child process, which starts with a copy-on-write image of the data as it was when 
+the Snapshot was created, so the data can keep changing while the save runs, and extra
+memory is only used for the pages that are changed before the save finishes.
+*/
+
+#include <stdio.h> /* for the declaration of FILE */
+
+/* incomplete declaration */
+struct Snapshot;
+
+/* A function that saves the data to the file */
+typedef void (*Snapshot_save_fp_t) (FILE* outfile, void* data_ptr);
+
+/* Values returned by get_Snapshot_status */
+#define SNAPSHOT_RUNNING 0
+#define SNAPSHOT_COMPLETED 1
+#define SNAPSHOT_FAILED 2
+
+/* Create a Snapshot object that saves the data to the open file with save_func in a child
+process. The file belongs to the Snapshot from then on. Returns NULL if the child process
+could not be started, in which case the file is left open. */
+struct Snapshot* create_Snapshot(FILE* outfile, Snapshot_save_fp_t save_func, void* data_ptr);
+
+/* Destroy a Snapshot object, first waiting for the save to finish if it is still running. */
+void destroy_Snapshot(struct Snapshot* snapshot_ptr);
+
+/* Return the status of the save, and set bytes_written_ptr to the size of the file so far. */
+int get_Snapshot_status(struct Snapshot* snapshot_ptr, long* bytes_written_ptr);
+
+#endif
@@ -0,0 +1,407 @@
+#include "Title_index.h"
+#include "Record.h"
+#include "Ordered_container.h"
+#include "Utility.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define TRIGRAM_LENGTH 3
+#define EMPTY_TRIGRAM -1
+#define INITIAL_TABLE_SIZE 1024	/* must be a power of two */
+#define SIMILAR_SEARCH_LISTS 2
+
+/* the records whose titles contain one trigram, in ID order */
+struct Posting_list {
+	int trigram;				/* EMPTY_TRIGRAM if this slot of the table is unused */
+	int size;
+	int allocation;
+	struct Record** records;
+};
+
+/* a Title_index contains an open addressing hash table of posting lists, and the container
+of all the records for searches with texts too short to use the table */
+struct Title_index {
+	struct Posting_list* table;
+	int table_size;				/* always a power of two */
+	int table_used;
+	const struct Ordered_container* all_records;
+};
+
+/* the text and kind of a search through all the records, and the records found so far */
+struct Title_search {
+	const char* text;
+	int kind;
+	struct Record** results;
+	int count;
+};
+
+/* Return the trigram starting at the given character, ignoring case */
+static int trigram_at(const char* characters);
+
+/* Return the posting list for the trigram, or NULL if there is none and create is zero;
+if create is non-zero, an empty list is added for the trigram when there is none. */
+static struct Posting_list* find_posting_list(struct Title_index* index_ptr, int trigram, int create);
+
+/* Double the size of the hash table */
+static void grow_table(struct Title_index* index_ptr);
+
+/* Return the position of the first record in a posting list whose ID is not less than the given ID */
+static int posting_list_lower_bound(const struct Posting_list* list_ptr, int ID);
+
+/* Add a record to a posting list in ID order, unless it is already there */
+static void posting_list_add(struct Posting_list* list_ptr, struct Record* record_ptr);
+
+/* Remove a record from a posting list if it is there */
+static void posting_list_remove(struct Posting_list* list_ptr, struct Record* record_ptr);
+
+/* Add a record to the results of a search through all the records if its title matches */
+static void search_record(void* record_ptr, void* search_ptr);
+
+/* Return non-zero if the title matches the text in the given kind of search */
+static int title_matches(const char* title, const char* text, int kind);
+
+/* Return non-zero if the text occurs in the title, ignoring case */
+static int contains_ignore_case(const char* title, const char* text);
+
+/* Return non-zero if the strings are equal, ignoring case, after at most one
+insertion, deletion, or substitution */
+static int within_one_edit_ignore_case(const char* first, const char* second);
+
+/* Compare pointers to records by the records' titles, for use with qsort */
+static int record_ptr_compare_title(const void* first_record_ptr, const void* second_record_ptr);
+
+/* Create an empty Title_index object for the records in the container, which is in title order
+and is searched for texts too short to use the trigrams. */
+struct Title_index* create_Title_index(const struct Ordered_container* all_records)
+{
+	struct Title_index *index = malloc(sizeof(struct Title_index));
+	int i;
+	index->table_size = INITIAL_TABLE_SIZE;
+	index->table_used = 0;
+	index->table = malloc(INITIAL_TABLE_SIZE * sizeof(struct Posting_list));
+	for (i = 0; i < INITIAL_TABLE_SIZE; i++)
+	{
+		index->table[i].trigram = EMPTY_TRIGRAM;
+	}
+	index->all_records = all_records;
+	return index;
+}
+
+/* Destroy a Title_index object; the records are not destroyed. */
+void destroy_Title_index(struct Title_index* index_ptr)
+{
+	clear_Title_index(index_ptr);
+	free(index_ptr->table);
+	free(index_ptr);
+}
+
+/* Add a record to the index. */
+void add_Title_index_record(struct Title_index* index_ptr, struct Record* record_ptr)
+{
+	const char *title = get_Record_title(record_ptr);
+	int length = strlen(title);
+	int i;
+	for (i = 0; i + TRIGRAM_LENGTH <= length; i++)
+	{
+		posting_list_add(find_posting_list(index_ptr, trigram_at(title + i), 1), record_ptr);
+	}
+}
+
+/* Remove a record from the index. */
+void remove_Title_index_record(struct Title_index* index_ptr, struct Record* record_ptr)
+{
+	const char *title = get_Record_title(record_ptr);
+	int length = strlen(title);
+	int i;
+	for (i = 0; i + TRIGRAM_LENGTH <= length; i++)
+	{
+		struct Posting_list *list = find_posting_list(index_ptr, trigram_at(title + i), 0);
+		if (list)
+		{
+			posting_list_remove(list, record_ptr);
+		}
+	}
+}
+
+/* Remove all records from the index. */
+void clear_Title_index(struct Title_index* index_ptr)
+{
+	int i;
+	for (i = 0; i < index_ptr->table_size; i++)
+	{
+		if (index_ptr->table[i].trigram != EMPTY_TRIGRAM)
+		{
+			free(index_ptr->table[i].records);
+			index_ptr->table[i].trigram = EMPTY_TRIGRAM;
+		}
+	}
+	index_ptr->table_used = 0;
+}
+
+/* Find the records whose titles match the text in the given kind of search.
+Returns an array of the records in title order, which the caller must free,
+and sets count_ptr to the number of records in it. */
+struct Record** search_Title_index(struct Title_index* index_ptr, const char* text, int kind, int* count_ptr)
+{
+	struct Posting_list *candidates[SIMILAR_SEARCH_LISTS];
+	struct Record **results;
+	int length = strlen(text);
+	int lists = 1;
+	int total = 0;
+	int count = 0;
+	int i, j;
+	if (kind == TITLE_SEARCH_SIMILAR ? length - TRIGRAM_LENGTH < TRIGRAM_LENGTH : length < TRIGRAM_LENGTH)
+	{
+		/* the text is too short for the trigrams, so every record is checked, already in title order */
+		struct Title_search search;
+		search.text = text;
+		search.kind = kind;
+		search.results = malloc((OC_get_size(index_ptr->all_records) + 1) * sizeof(struct Record *));
+		search.count = 0;
+		OC_apply_arg(index_ptr->all_records, search_record, &search);
+		*count_ptr = search.count;
+		return search.results;
+	}
+	if (kind == TITLE_SEARCH_SIMILAR)
+	{
+		/* the first and last trigrams are far enough apart that one edit cannot change both */
+		candidates[0] = find_posting_list(index_ptr, trigram_at(text), 0);
+		candidates[1] = find_posting_list(index_ptr, trigram_at(text + length - TRIGRAM_LENGTH), 0);
+		lists = 2;
+	}
+	else
+	{
+		/* every trigram of the text is in a matching title, so check the shortest list */
+		candidates[0] = find_posting_list(index_ptr, trigram_at(text), 0);
+		for (i = 1; candidates[0] && i + TRIGRAM_LENGTH <= length; i++)
+		{
+			struct Posting_list *list = find_posting_list(index_ptr, trigram_at(text + i), 0);
+			if (!list || list->size < candidates[0]->size)
+			{
+				candidates[0] = list;
+			}
+		}
+	}
+	for (i = 0; i < lists; i++)
+	{
+		total += candidates[i] ? candidates[i]->size : 0;
+	}
+	results = malloc((total > 0 ? total : 1) * sizeof(struct Record *));
+	for (i = 0; i < lists; i++)
+	{
+		for (j = 0; candidates[i] && j < candidates[i]->size; j++)
+		{
+			struct Record *record = candidates[i]->records[j];
+			if (title_matches(get_Record_title(record), text, kind))
+			{
+				results[count++] = record;
+			}
+		}
+	}
+	qsort(results, count, sizeof(struct Record *), record_ptr_compare_title);
+	/* a record in both lists of a similar search is now next to itself */
+	for (i = 0, j = 0; i < count; i++)
+	{
+		if (j == 0 || results[j - 1] != results[i])
+		{
+			results[j++] = results[i];
+		}
+	}
+	*count_ptr = j;
+	return results;
+}
+
+/* Return the trigram starting at the given character, ignoring case */
+static int trigram_at(const char* characters)
+{
+	return tolower((unsigned char)characters[0]) << 16 | tolower((unsigned char)characters[1]) << 8
+		| tolower((unsigned char)characters[2]);
+}
+
+/* Return the posting list for the trigram, or NULL if there is none and create is zero;
+if create is non-zero, an empty list is added for the trigram when there is none. */
+static struct Posting_list* find_posting_list(struct Title_index* index_ptr, int trigram, int create)
+{
+	unsigned int hash;
+	struct Posting_list *list;
+	if (create && (index_ptr->table_used + 1) * 2 > index_ptr->table_size)
+	{
+		grow_table(index_ptr);
+	}
+	hash = (unsigned int)trigram * 2654435761u;
+	hash ^= hash >> 15;
+	for (list = &index_ptr->table[hash & (index_ptr->table_size - 1)]; list->trigram != trigram;
+		list = &index_ptr->table[(list - index_ptr->table + 1) & (index_ptr->table_size - 1)])
+	{
+		if (list->trigram == EMPTY_TRIGRAM)
+		{
+			if (!create)
+			{
+				return NULL;
+			}
+			list->trigram = trigram;
+			list->size = 0;
+			list->allocation = 0;
+			list->records = NULL;
+			index_ptr->table_used++;
+			break;
+		}
+	}
+	return list;
+}
+
+/* Double the size of the hash table */
+static void grow_table(struct Title_index* index_ptr)
+{
+	struct Posting_list *old_table = index_ptr->table;
+	int old_size = index_ptr->table_size;
+	int i;
+	index_ptr->table_size = old_size * 2;
+	index_ptr->table_used = 0;
+	index_ptr->table = malloc(index_ptr->table_size * sizeof(struct Posting_list));
+	for (i = 0; i < index_ptr->table_size; i++)
+	{
+		index_ptr->table[i].trigram = EMPTY_TRIGRAM;
+	}
+	for (i = 0; i < old_size; i++)
+	{
+		if (old_table[i].trigram != EMPTY_TRIGRAM)
+		{
+			*find_posting_list(index_ptr, old_table[i].trigram, 1) = old_table[i];
+		}
+	}
+	free(old_table);
+}
+
+/* Return the position of the first record in a posting list whose ID is not less than the given ID */
+static int posting_list_lower_bound(const struct Posting_list* list_ptr, int ID)
+{
+	int low = 0;
+	int high = list_ptr->size;
+	while (low < high)
+	{
+		int middle = low + (high - low) / 2;
+		if (get_Record_ID(list_ptr->records[middle]) < ID)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return low;
+}
+
+/* Add a record to a posting list in ID order, unless it is already there */
+static void posting_list_add(struct Posting_list* list_ptr, struct Record* record_ptr)
+{
+	int ID = get_Record_ID(record_ptr);
+	int position = list_ptr->size;
+	/* new records have the largest ID, so this is usually the end of the list */
+	if (position > 0 && get_Record_ID(list_ptr->records[position - 1]) >= ID)
+	{
+		position = posting_list_lower_bound(list_ptr, ID);
+		/* a trigram that occurs twice in the title was already added for this record */
+		if (list_ptr->records[position] == record_ptr)
+		{
+			return;
+		}
+	}
+	if (list_ptr->size == list_ptr->allocation)
+	{
+		list_ptr->allocation = list_ptr->allocation * 2 + 1;
+		list_ptr->records = realloc(list_ptr->records, list_ptr->allocation * sizeof(struct Record *));
+	}
+	memmove(list_ptr->records + position + 1, list_ptr->records + position, (list_ptr->size - position) * sizeof(struct Record *));
+	list_ptr->records[position] = record_ptr;
+	list_ptr->size++;
+}
+
+/* Remove a record from a posting list if it is there */
+static void posting_list_remove(struct Posting_list* list_ptr, struct Record* record_ptr)
+{
+	int position = posting_list_lower_bound(list_ptr, get_Record_ID(record_ptr));
+	if (position < list_ptr->size && list_ptr->records[position] == record_ptr)
+	{
+		list_ptr->size--;
+		memmove(list_ptr->records + position, list_ptr->records + position + 1, (list_ptr->size - position) * sizeof(struct Record *));
+	}
+}
+
+/* Add a record to the results of a search through all the records if its title matches */
+static void search_record(void* record_ptr, void* search_ptr)
+{
+	struct Title_search *search = search_ptr;
+	if (title_matches(get_Record_title(record_ptr), search->text, search->kind))
+	{
+		search->results[search->count++] = record_ptr;
+	}
+}
+
+/* Return non-zero if the title matches the text in the given kind of search */
+static int title_matches(const char* title, const char* text, int kind)
+{
+	switch (kind)
+	{
+		case TITLE_SEARCH_CONTAINS:
+			return strstr(title, text) != NULL;
+		case TITLE_SEARCH_IGNORE_CASE:
+			return contains_ignore_case(title, text);
+		default:
+			return within_one_edit_ignore_case(title, text);
+	}
+}
+
+/* Return non-zero if the text occurs in the title, ignoring case */
+static int contains_ignore_case(const char* title, const char* text)
+{
+	for (; *title; title++)
+	{
+		int i;
+		for (i = 0; text[i] && tolower((unsigned char)title[i]) == tolower((unsigned char)text[i]); i++)
+		{
+		}
+		if (!text[i])
+		{
+			return 1;
+		}
+	}
+	return !*text;
+}
+
+/* Return non-zero if the strings are equal, ignoring case, after at most one
+insertion, deletion, or substitution */
+static int within_one_edit_ignore_case(const char* first, const char* second)
+{
+	int first_length = strlen(first);
+	int second_length = strlen(second);
+	int difference = first_length - second_length;
+	if (difference < -1 || difference > 1)
+	{
+		return 0;
+	}
+	/* skip the common prefix, then the rest must be equal after skipping the edited character */
+	while (*first && tolower((unsigned char)*first) == tolower((unsigned char)*second))
+	{
+		first++;
+		second++;
+	}
+	if (!*first && !*second)
+	{
+		return 1;
+	}
+	first += difference >= 0;
+	second += difference <= 0;
+	for (; *first && tolower((unsigned char)*first) == tolower((unsigned char)*second); first++, second++)
+	{
+	}
+	return !*first && !*second;
+}
+
+/* Compare pointers to records by the records' titles, for use with qsort */
+static int record_ptr_compare_title(const void* first_record_ptr, const void* second_record_ptr)
+{
+	return record_compare_title(*(void * const *)first_record_ptr, *(void * const *)second_record_ptr);
+}
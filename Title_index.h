@@ -0,0 +1,55 @@
+#ifndef TITLE_INDEX_H
+#define TITLE_INDEX_H
+
+/*
+A Title_index is an opaque type for finding records by part of their title, or by
+a title that is a typing mistake away from theirs, without looking at every title.
+
+For each trigram (three consecutive characters, compared ignoring case) the index keeps
+the records whose titles contain it. Every trigram of a search text must be in a title
+that contains the text, so only the records in the shortest of those lists are checked.
+One edit to a title changes at most three trigrams in a row, so a title within one edit
+of the search text contains its first or its last trigram if it has at least four.
+Texts too short for this are checked against every record, in the container of all the
+records in title order that the index is created with.
+
+Each list is kept in ID order, so adding or removing a record finds its place in a list by
+binary search, and a record with a new largest ID goes at the end of every list.
+
+The index does not own the records; the caller adds every record to it and removes
+each one before destroying it.
+*/
+
+/* incomplete declarations */
+struct Title_index;
+struct Record;
+struct Ordered_container;
+
+/* Kinds of search done by search_Title_index */
+#define TITLE_SEARCH_CONTAINS 0		/* titles containing the text */
+#define TITLE_SEARCH_IGNORE_CASE 1	/* titles containing the text, ignoring case */
+#define TITLE_SEARCH_SIMILAR 2		/* titles one insertion, deletion, or substitution
+									from the text, ignoring case */
+
+/* Create an empty Title_index object for the records in the container, which is in title order
+and is searched for texts too short to use the trigrams. */
+struct Title_index* create_Title_index(const struct Ordered_container* all_records);
+
+/* Destroy a Title_index object; the records are not destroyed. */
+void destroy_Title_index(struct Title_index* index_ptr);
+
+/* Add a record to the index. */
+void add_Title_index_record(struct Title_index* index_ptr, struct Record* record_ptr);
+
+/* Remove a record from the index. */
+void remove_Title_index_record(struct Title_index* index_ptr, struct Record* record_ptr);
+
+/* Remove all records from the index. */
+void clear_Title_index(struct Title_index* index_ptr);
+
+/* Find the records whose titles match the text in the given kind of search.
+Returns an array of the records in title order, which the caller must free,
+and sets count_ptr to the number of records in it. */
+struct Record** search_Title_index(struct Title_index* index_ptr, const char* text, int kind, int* count_ptr);
+
+#endif
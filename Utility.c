@@ -1,5 +1,6 @@
 #include "Utility.h"
 #include "Record.h"
+#include "Lexer.h"
 #include <ctype.h>
 #include <string.h>
 #include "p1_globals.h"
@@ -13,7 +14,7 @@ void record_print(void* record)
 /* Compare records by their titles */
 int record_compare_title(const void* first_record, const void* second_record)
 {
-	return strcmp(get_Record_title((const struct Record *)first_record), get_Record_title((const struct Record *)second_record));
+	return compare_Record_titles((const struct Record *)first_record, (const struct Record *)second_record);
 }
 
 /* Compare records by their ids */
@@ -34,19 +35,19 @@ int record_id_compare(const void* id, const void* record)
 	return *((int *)id) - get_Record_ID((const struct Record *)record);
 }
 
-/* Read in a title from the specified file, returns pointer to the title on success and a NULL on failure */
-char * read_title(char *title, FILE *infile)
+/* Read in a title from the rest of the line, returns pointer to the title on success and a NULL on failure */
+char * read_title(char *title, struct Lexer *input)
 {
 	int i;
 	int index = 0;
 	int last_was_whitespace = 1;
 	int last_char_index = -1;
-	if (!fgets(title, TITLE_BUFFER_SIZE, infile))
+	if (!lex_line(input, title, TITLE_BUFFER_SIZE))
 	{
 		/* title read error */
 		return NULL;
 	}
-	for (i = 0; i < strlen(title); i++)
+	for (i = 0; title[i] != '\0'; i++)
 	{
 		char current = *(title + i);
 		int is_whitespace = isspace(current);
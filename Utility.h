@@ -5,6 +5,9 @@
 #include "p1_globals.h"
 #include <stdio.h>
 
+/* incomplete declaration */
+struct Lexer;
+
 #define TITLE_BUFFER_SIZE 64
 #define TITLE_SCAN_BUFFER "%63s"
 #define TITLE_BUFFER_END 62
@@ -16,6 +19,9 @@
 #define FILE_SCAN_BUFFER "%31s"
 #define RATING_MAX 5
 #define RATING_MIN 1
+#define SAVE_FORMAT_HEADER "Version"
+#define SAVE_FORMAT_VERSION 3
+#define SAVE_FORMAT_SECTIONS_VERSION 3	/* the first version with a table of sections and their checksums */
 
 /* Print a record */
 void record_print(void* record);
@@ -32,7 +38,7 @@ int record_title_compare(const void* title, const void* record);
 /* Compares a record's id with the given id */
 int record_id_compare(const void* title, const void* record);
 
-/* Read in a title from the specified file, returns 0 on success and nonzero on failure */
-char * read_title(char *title, FILE *infile);
+/* Read in a title from the rest of the line, returns a pointer to the title on success and NULL on failure */
+char * read_title(char *title, struct Lexer *input);
 
 #endif
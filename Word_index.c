@@ -0,0 +1,712 @@
+#include "Word_index.h"
+#include "Record.h"
+#include "Utility.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#define POSTING_SKIP_INTERVAL 32
+#define INITIAL_TABLE_SIZE 1024		/* must be a power of two */
+#define QUERY_WORDS_MAX (TITLE_BUFFER_SIZE / 2)
+#define VARIABLE_BYTE_MAX 5			/* bytes needed for any int */
+
+/* the ID of a posting at a skip interval, and the offset of the byte after it */
+struct Skip_entry {
+	int ID;
+	int offset;
+};
+
+/* the IDs of the records whose titles contain one word, as differences in increasing order,
+with a skip entry for every POSTING_SKIP_INTERVAL postings starting with the first */
+struct Posting_list {
+	char* word;					/* NULL if this slot of the table is unused */
+	unsigned char* bytes;
+	int byte_count;
+	int byte_allocation;
+	int size;
+	int last_ID;
+	struct Skip_entry* skips;
+	int skip_allocation;
+};
+
+/* a Word_index contains an open addressing hash table of posting lists */
+struct Word_index {
+	struct Posting_list* table;
+	int table_size;				/* always a power of two */
+	int table_used;
+};
+
+/* a position in a posting list: the posting read last, and the offset of the byte after it */
+struct Posting_cursor {
+	struct Posting_list* list;
+	int position;				/* -1 before the first posting, size after the last */
+	int offset;
+	int ID;
+};
+
+/* Copy the next word of the text into the buffer in lower case and move the text pointer past it.
+Returns 0 if there are no more words. */
+static int next_word(const char** text_ptr, char* word);
+
+/* Return the posting list for the word, or NULL if there is none and create is zero;
+if create is non-zero, an empty list is added for the word when there is none. */
+static struct Posting_list* find_posting_list(struct Word_index* index_ptr, const char* word, int create);
+
+/* Double the size of the hash table */
+static void grow_table(struct Word_index* index_ptr);
+
+/* Add an ID larger than all of those in the list to its end */
+static void posting_list_append(struct Posting_list* list_ptr, int ID);
+
+/* Add an ID to the list if it is not there already, in any position */
+static void posting_list_insert(struct Posting_list* list_ptr, int ID);
+
+/* Remove an ID from the list if it is there */
+static void posting_list_remove(struct Posting_list* list_ptr, int ID);
+
+/* Set the first cursor to the last posting with an ID less than the given one, or before the
+first posting if there is none, and the second to the posting after it */
+static void posting_list_locate(struct Posting_list* list_ptr, int ID, struct Posting_cursor* before_ptr,
+	struct Posting_cursor* after_ptr);
+
+/* Make sure the list has room for the given number of bytes */
+static void reserve_bytes(struct Posting_list* list_ptr, int byte_count);
+
+/* Make sure the list has room for the given number of skip entries */
+static void reserve_skips(struct Posting_list* list_ptr, int skip_count);
+
+/* Remove a posting list that has become empty from the hash table */
+static void remove_posting_list(struct Word_index* index_ptr, struct Posting_list* list_ptr);
+
+/* Write a difference at the bytes, and return the number of bytes it takes */
+static int encode_difference(unsigned char* bytes, unsigned int difference);
+
+/* Return the number of bytes a difference takes */
+static int difference_size(unsigned int difference);
+
+/* Read the difference at the offset, and move the offset past it */
+static unsigned int decode_difference(const unsigned char* bytes, int* offset_ptr);
+
+/* Return the offset of the first byte of the difference that ends just before the offset */
+static int difference_start(const unsigned char* bytes, int offset);
+
+/* Start a cursor before the first posting of the list */
+static void cursor_start(struct Posting_cursor* cursor_ptr, struct Posting_list* list_ptr);
+
+/* Move the cursor to the next posting; returns 0 if there are no more */
+static int cursor_next(struct Posting_cursor* cursor_ptr);
+
+/* Move the cursor forward to the first posting with an ID at least as large as the target,
+galloping through the skip entries; returns 0 if there is none */
+static int cursor_seek(struct Posting_cursor* cursor_ptr, int target);
+
+/* Compare pointers to posting lists by the number of postings, for use with qsort */
+static int list_ptr_compare_size(const void* first_list_ptr, const void* second_list_ptr);
+
+/* Create an empty Word_index object. */
+struct Word_index* create_Word_index(void)
+{
+	struct Word_index *index = malloc(sizeof(struct Word_index));
+	int i;
+	index->table_size = INITIAL_TABLE_SIZE;
+	index->table_used = 0;
+	index->table = malloc(INITIAL_TABLE_SIZE * sizeof(struct Posting_list));
+	for (i = 0; i < INITIAL_TABLE_SIZE; i++)
+	{
+		index->table[i].word = NULL;
+	}
+	return index;
+}
+
+/* Destroy a Word_index object. */
+void destroy_Word_index(struct Word_index* index_ptr)
+{
+	clear_Word_index(index_ptr);
+	free(index_ptr->table);
+	free(index_ptr);
+}
+
+/* Add a record to the index. */
+void add_Word_index_record(struct Word_index* index_ptr, const struct Record* record_ptr)
+{
+	const char *title = get_Record_title(record_ptr);
+	int ID = get_Record_ID(record_ptr);
+	char word[TITLE_BUFFER_SIZE];
+	while (next_word(&title, word))
+	{
+		struct Posting_list *list = find_posting_list(index_ptr, word, 1);
+		if (list->size == 0 || ID > list->last_ID)
+		{
+			posting_list_append(list, ID);
+		}
+		else if (ID != list->last_ID)
+		{
+			posting_list_insert(list, ID);
+		}
+	}
+}
+
+/* Remove a record from the index. */
+void remove_Word_index_record(struct Word_index* index_ptr, const struct Record* record_ptr)
+{
+	const char *title = get_Record_title(record_ptr);
+	char word[TITLE_BUFFER_SIZE];
+	while (next_word(&title, word))
+	{
+		struct Posting_list *list = find_posting_list(index_ptr, word, 0);
+		if (list)
+		{
+			posting_list_remove(list, get_Record_ID(record_ptr));
+			if (list->size == 0)
+			{
+				remove_posting_list(index_ptr, list);
+			}
+		}
+	}
+}
+
+/* Remove all records from the index. */
+void clear_Word_index(struct Word_index* index_ptr)
+{
+	int i;
+	for (i = 0; i < index_ptr->table_size; i++)
+	{
+		struct Posting_list *list = &index_ptr->table[i];
+		if (list->word)
+		{
+			free(list->word);
+			free(list->bytes);
+			free(list->skips);
+			list->word = NULL;
+		}
+	}
+	index_ptr->table_used = 0;
+}
+
+/* Find the records whose titles contain the words in the text; if require_all is non-zero,
+only records containing every word are found, otherwise records containing any of them.
+Returns an array of the matches in ID order, which the caller must free,
+and sets count_ptr to the number of matches in it. */
+struct Word_match* search_Word_index(struct Word_index* index_ptr, const char* text, int require_all, int* count_ptr)
+{
+	struct Posting_list *lists[QUERY_WORDS_MAX];
+	struct Posting_cursor cursors[QUERY_WORDS_MAX];
+	struct Word_match *matches;
+	char word[TITLE_BUFFER_SIZE];
+	int list_count = 0;
+	int total = 0;
+	int count = 0;
+	int missing = 0;
+	int i;
+	while (next_word(&text, word) && list_count < QUERY_WORDS_MAX)
+	{
+		struct Posting_list *list = find_posting_list(index_ptr, word, 0);
+		if (!list || list->size == 0)
+		{
+			missing = 1;
+			continue;
+		}
+		/* a repeated word has the same list */
+		for (i = 0; i < list_count && lists[i] != list; i++)
+		{
+		}
+		if (i == list_count)
+		{
+			lists[list_count++] = list;
+			total += list->size;
+		}
+	}
+	if (require_all && missing)
+	{
+		list_count = 0;
+	}
+	/* the shortest list goes first, to drive the intersection */
+	qsort(lists, list_count, sizeof(struct Posting_list *), list_ptr_compare_size);
+	matches = malloc((total > 0 ? total : 1) * sizeof(struct Word_match));
+	for (i = 0; i < list_count; i++)
+	{
+		cursor_start(&cursors[i], lists[i]);
+	}
+	if (list_count > 0 && require_all)
+	{
+		int more = cursor_next(&cursors[0]);
+		while (more)
+		{
+			int target = cursors[0].ID;
+			for (i = 1; i < list_count && more; i++)
+			{
+				more = cursor_seek(&cursors[i], target);
+				if (more && cursors[i].ID != target)
+				{
+					/* no record before this one can contain every word */
+					target = cursors[i].ID;
+					break;
+				}
+			}
+			if (!more)
+			{
+				break;
+			}
+			if (i == list_count)
+			{
+				matches[count].ID = target;
+				matches[count++].words = list_count;
+				more = cursor_next(&cursors[0]);
+			}
+			else
+			{
+				more = cursor_seek(&cursors[0], target);
+			}
+		}
+	}
+	else if (list_count > 0)
+	{
+		int active = 0;
+		for (i = 0; i < list_count; i++)
+		{
+			active += cursor_next(&cursors[i]);
+		}
+		while (active > 0)
+		{
+			int lowest = 0;
+			int words = 0;
+			for (i = 0; i < list_count; i++)
+			{
+				if (cursors[i].position < cursors[i].list->size && (words == 0 || cursors[i].ID < lowest))
+				{
+					lowest = cursors[i].ID;
+					words = 1;
+				}
+				else if (cursors[i].position < cursors[i].list->size && cursors[i].ID == lowest)
+				{
+					words++;
+				}
+			}
+			for (i = 0; i < list_count; i++)
+			{
+				if (cursors[i].position < cursors[i].list->size && cursors[i].ID == lowest && !cursor_next(&cursors[i]))
+				{
+					active--;
+				}
+			}
+			matches[count].ID = lowest;
+			matches[count++].words = words;
+		}
+	}
+	*count_ptr = count;
+	return matches;
+}
+
+/* Copy the next word of the text into the buffer in lower case and move the text pointer past it.
+Returns 0 if there are no more words. */
+static int next_word(const char** text_ptr, char* word)
+{
+	const char *text = *text_ptr;
+	int length = 0;
+	while (*text && !isalnum((unsigned char)*text))
+	{
+		text++;
+	}
+	for (; isalnum((unsigned char)*text); text++)
+	{
+		if (length < TITLE_BUFFER_SIZE - 1)
+		{
+			word[length++] = (char)tolower((unsigned char)*text);
+		}
+	}
+	word[length] = '\0';
+	*text_ptr = text;
+	return length > 0;
+}
+
+/* Return the posting list for the word, or NULL if there is none and create is zero;
+if create is non-zero, an empty list is added for the word when there is none. */
+static struct Posting_list* find_posting_list(struct Word_index* index_ptr, const char* word, int create)
+{
+	unsigned int hash = 2166136261u;
+	const char *character;
+	struct Posting_list *list;
+	if (create && (index_ptr->table_used + 1) * 2 > index_ptr->table_size)
+	{
+		grow_table(index_ptr);
+	}
+	for (character = word; *character; character++)
+	{
+		hash = (hash ^ (unsigned char)*character) * 16777619u;
+	}
+	for (list = &index_ptr->table[hash & (index_ptr->table_size - 1)]; !list->word || strcmp(list->word, word) != 0;
+		list = &index_ptr->table[(list - index_ptr->table + 1) & (index_ptr->table_size - 1)])
+	{
+		if (!list->word)
+		{
+			if (!create)
+			{
+				return NULL;
+			}
+			list->word = strcpy(malloc(strlen(word) + 1), word);
+			list->bytes = NULL;
+			list->byte_count = 0;
+			list->byte_allocation = 0;
+			list->size = 0;
+			list->last_ID = 0;
+			list->skips = NULL;
+			list->skip_allocation = 0;
+			index_ptr->table_used++;
+			break;
+		}
+	}
+	return list;
+}
+
+/* Double the size of the hash table */
+static void grow_table(struct Word_index* index_ptr)
+{
+	struct Posting_list *old_table = index_ptr->table;
+	int old_size = index_ptr->table_size;
+	int i;
+	index_ptr->table_size = old_size * 2;
+	index_ptr->table_used = 0;
+	index_ptr->table = malloc(index_ptr->table_size * sizeof(struct Posting_list));
+	for (i = 0; i < index_ptr->table_size; i++)
+	{
+		index_ptr->table[i].word = NULL;
+	}
+	for (i = 0; i < old_size; i++)
+	{
+		if (old_table[i].word)
+		{
+			struct Posting_list *list = find_posting_list(index_ptr, old_table[i].word, 1);
+			free(list->word);
+			*list = old_table[i];
+		}
+	}
+	free(old_table);
+}
+
+/* Add an ID larger than all of those in the list to its end */
+static void posting_list_append(struct Posting_list* list_ptr, int ID)
+{
+	reserve_bytes(list_ptr, list_ptr->byte_count + VARIABLE_BYTE_MAX);
+	list_ptr->byte_count += encode_difference(list_ptr->bytes + list_ptr->byte_count, (unsigned int)(ID - list_ptr->last_ID));
+	if (list_ptr->size % POSTING_SKIP_INTERVAL == 0)
+	{
+		int skip = list_ptr->size / POSTING_SKIP_INTERVAL;
+		reserve_skips(list_ptr, skip + 1);
+		list_ptr->skips[skip].ID = ID;
+		list_ptr->skips[skip].offset = list_ptr->byte_count;
+	}
+	list_ptr->size++;
+	list_ptr->last_ID = ID;
+}
+
+/* Add an ID to the list if it is not there already, in any position.
+The difference of the posting after it is replaced by two, the difference from the posting
+before it to the ID and from the ID to that posting, and the bytes after them are shifted.
+A skip entry at or after the new posting is now for the posting before the one it was for. */
+static void posting_list_insert(struct Posting_list* list_ptr, int ID)
+{
+	struct Posting_cursor before, after;
+	int position, first_size, shift, skip_count, skip;
+	posting_list_locate(list_ptr, ID, &before, &after);
+	if (after.position == list_ptr->size || after.ID == ID)
+	{
+		return;
+	}
+	position = after.position;
+	first_size = difference_size((unsigned int)(ID - before.ID));
+	shift = first_size + difference_size((unsigned int)(after.ID - ID)) - (after.offset - before.offset);
+	reserve_bytes(list_ptr, list_ptr->byte_count + shift);
+	memmove(list_ptr->bytes + after.offset + shift, list_ptr->bytes + after.offset, list_ptr->byte_count - after.offset);
+	encode_difference(list_ptr->bytes + before.offset, (unsigned int)(ID - before.ID));
+	encode_difference(list_ptr->bytes + before.offset + first_size, (unsigned int)(after.ID - ID));
+	list_ptr->byte_count += shift;
+	skip_count = (list_ptr->size + POSTING_SKIP_INTERVAL - 1) / POSTING_SKIP_INTERVAL;
+	list_ptr->size++;
+	reserve_skips(list_ptr, (list_ptr->size + POSTING_SKIP_INTERVAL - 1) / POSTING_SKIP_INTERVAL);
+	for (skip = (position + POSTING_SKIP_INTERVAL - 1) / POSTING_SKIP_INTERVAL; skip * POSTING_SKIP_INTERVAL < list_ptr->size; skip++)
+	{
+		struct Skip_entry *entry = &list_ptr->skips[skip];
+		if (skip * POSTING_SKIP_INTERVAL == position)
+		{
+			entry->ID = ID;
+			entry->offset = before.offset + first_size;
+		}
+		else if (skip == skip_count)
+		{
+			/* a new entry, for what was the last posting */
+			entry->ID = list_ptr->last_ID;
+			entry->offset = list_ptr->byte_count;
+		}
+		else
+		{
+			/* the posting before the old one ends where the old one starts */
+			int end = difference_start(list_ptr->bytes, entry->offset + shift);
+			int offset = end;
+			entry->ID -= (int)decode_difference(list_ptr->bytes, &offset);
+			entry->offset = end;
+		}
+	}
+}
+
+/* Remove an ID from the list if it is there.
+The differences of the posting and the one after it are replaced by the difference from the
+posting before it to the one after it, and the bytes after them are shifted. A skip entry at or
+after the posting is now for the posting after the one it was for. */
+static void posting_list_remove(struct Posting_list* list_ptr, int ID)
+{
+	struct Posting_cursor before, after;
+	int position, skip;
+	posting_list_locate(list_ptr, ID, &before, &after);
+	if (after.position == list_ptr->size || after.ID != ID)
+	{
+		return;
+	}
+	position = after.position;
+	if (cursor_next(&after))
+	{
+		int next_size = difference_size((unsigned int)(after.ID - before.ID));
+		int shift = before.offset + next_size - after.offset;
+		encode_difference(list_ptr->bytes + before.offset, (unsigned int)(after.ID - before.ID));
+		memmove(list_ptr->bytes + after.offset + shift, list_ptr->bytes + after.offset, list_ptr->byte_count - after.offset);
+		list_ptr->byte_count += shift;
+		list_ptr->size--;
+		for (skip = (position + POSTING_SKIP_INTERVAL - 1) / POSTING_SKIP_INTERVAL; skip * POSTING_SKIP_INTERVAL < list_ptr->size; skip++)
+		{
+			struct Skip_entry *entry = &list_ptr->skips[skip];
+			if (skip * POSTING_SKIP_INTERVAL == position)
+			{
+				entry->ID = after.ID;
+				entry->offset = before.offset + next_size;
+			}
+			else
+			{
+				/* the posting after the old one starts where the old one ended */
+				entry->offset += shift;
+				entry->ID += (int)decode_difference(list_ptr->bytes, &entry->offset);
+			}
+		}
+	}
+	else
+	{
+		/* the last posting was removed, and a skip entry for it is no longer counted */
+		list_ptr->byte_count = before.offset;
+		list_ptr->size--;
+		list_ptr->last_ID = before.ID;
+	}
+}
+
+/* Set the first cursor to the last posting with an ID less than the given one, or before the
+first posting if there is none, and the second to the posting after it */
+static void posting_list_locate(struct Posting_list* list_ptr, int ID, struct Posting_cursor* before_ptr,
+	struct Posting_cursor* after_ptr)
+{
+	int low = -1;
+	int high = (list_ptr->size + POSTING_SKIP_INTERVAL - 1) / POSTING_SKIP_INTERVAL;
+	/* find the last skip entry with a smaller ID, and decode from there */
+	while (high - low > 1)
+	{
+		int middle = low + (high - low) / 2;
+		if (list_ptr->skips[middle].ID < ID)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	cursor_start(before_ptr, list_ptr);
+	if (low >= 0)
+	{
+		before_ptr->position = low * POSTING_SKIP_INTERVAL;
+		before_ptr->offset = list_ptr->skips[low].offset;
+		before_ptr->ID = list_ptr->skips[low].ID;
+	}
+	*after_ptr = *before_ptr;
+	while (cursor_next(after_ptr) && after_ptr->ID < ID)
+	{
+		*before_ptr = *after_ptr;
+	}
+}
+
+/* Make sure the list has room for the given number of bytes */
+static void reserve_bytes(struct Posting_list* list_ptr, int byte_count)
+{
+	if (byte_count > list_ptr->byte_allocation)
+	{
+		list_ptr->byte_allocation = list_ptr->byte_allocation * 2 + VARIABLE_BYTE_MAX;
+		if (byte_count > list_ptr->byte_allocation)
+		{
+			list_ptr->byte_allocation = byte_count;
+		}
+		list_ptr->bytes = realloc(list_ptr->bytes, list_ptr->byte_allocation);
+	}
+}
+
+/* Make sure the list has room for the given number of skip entries */
+static void reserve_skips(struct Posting_list* list_ptr, int skip_count)
+{
+	if (skip_count > list_ptr->skip_allocation)
+	{
+		list_ptr->skip_allocation = list_ptr->skip_allocation * 2 + 1;
+		list_ptr->skips = realloc(list_ptr->skips, list_ptr->skip_allocation * sizeof(struct Skip_entry));
+	}
+}
+
+/* Remove a posting list that has become empty from the hash table.
+The lists after it up to the next unused slot are put back in the table, so that none of them
+is left after an unused slot it would be probed past. */
+static void remove_posting_list(struct Word_index* index_ptr, struct Posting_list* list_ptr)
+{
+	int slot = (int)(list_ptr - index_ptr->table);
+	free(list_ptr->word);
+	free(list_ptr->bytes);
+	free(list_ptr->skips);
+	list_ptr->word = NULL;
+	index_ptr->table_used--;
+	for (slot = (slot + 1) & (index_ptr->table_size - 1); index_ptr->table[slot].word;
+		slot = (slot + 1) & (index_ptr->table_size - 1))
+	{
+		struct Posting_list moved = index_ptr->table[slot];
+		struct Posting_list *list;
+		index_ptr->table[slot].word = NULL;
+		index_ptr->table_used--;
+		list = find_posting_list(index_ptr, moved.word, 1);
+		free(list->word);
+		*list = moved;
+	}
+}
+
+/* Write a difference at the bytes, and return the number of bytes it takes */
+static int encode_difference(unsigned char* bytes, unsigned int difference)
+{
+	int count = 0;
+	while (difference >= 0x80)
+	{
+		bytes[count++] = (unsigned char)(difference | 0x80);
+		difference >>= 7;
+	}
+	bytes[count++] = (unsigned char)difference;
+	return count;
+}
+
+/* Return the number of bytes a difference takes */
+static int difference_size(unsigned int difference)
+{
+	int count = 1;
+	for (; difference >= 0x80; difference >>= 7)
+	{
+		count++;
+	}
+	return count;
+}
+
+/* Read the difference at the offset, and move the offset past it */
+static unsigned int decode_difference(const unsigned char* bytes, int* offset_ptr)
+{
+	unsigned int difference = 0;
+	int shift = 0;
+	while (bytes[*offset_ptr] & 0x80)
+	{
+		difference |= (unsigned int)(bytes[(*offset_ptr)++] & 0x7f) << shift;
+		shift += 7;
+	}
+	difference |= (unsigned int)bytes[(*offset_ptr)++] << shift;
+	return difference;
+}
+
+/* Return the offset of the first byte of the difference that ends just before the offset;
+only the last byte of a difference has its high bit clear */
+static int difference_start(const unsigned char* bytes, int offset)
+{
+	offset--;
+	while (offset > 0 && (bytes[offset - 1] & 0x80))
+	{
+		offset--;
+	}
+	return offset;
+}
+
+/* Start a cursor before the first posting of the list */
+static void cursor_start(struct Posting_cursor* cursor_ptr, struct Posting_list* list_ptr)
+{
+	cursor_ptr->list = list_ptr;
+	cursor_ptr->position = -1;
+	cursor_ptr->offset = 0;
+	cursor_ptr->ID = 0;
+}
+
+/* Move the cursor to the next posting; returns 0 if there are no more */
+static int cursor_next(struct Posting_cursor* cursor_ptr)
+{
+	if (cursor_ptr->position + 1 >= cursor_ptr->list->size)
+	{
+		cursor_ptr->position = cursor_ptr->list->size;
+		return 0;
+	}
+	cursor_ptr->ID += (int)decode_difference(cursor_ptr->list->bytes, &cursor_ptr->offset);
+	cursor_ptr->position++;
+	return 1;
+}
+
+/* Move the cursor forward to the first posting with an ID at least as large as the target,
+galloping through the skip entries; returns 0 if there is none */
+static int cursor_seek(struct Posting_cursor* cursor_ptr, int target)
+{
+	const struct Skip_entry *skips = cursor_ptr->list->skips;
+	int skip_count = (cursor_ptr->list->size + POSTING_SKIP_INTERVAL - 1) / POSTING_SKIP_INTERVAL;
+	int current, low, high, step;
+	if (cursor_ptr->position >= cursor_ptr->list->size)
+	{
+		return 0;
+	}
+	if (cursor_ptr->position >= 0 && cursor_ptr->ID >= target)
+	{
+		return 1;
+	}
+	/* find the last skip entry not past the target, doubling the step until one is past it */
+	current = cursor_ptr->position < 0 ? -1 : cursor_ptr->position / POSTING_SKIP_INTERVAL;
+	low = current;
+	high = current + 1;
+	for (step = 1; high < skip_count && skips[high].ID <= target; step *= 2)
+	{
+		low = high;
+		high = current + step * 2;
+	}
+	if (high > skip_count)
+	{
+		high = skip_count;
+	}
+	while (high - low > 1)
+	{
+		int middle = low + (high - low) / 2;
+		if (skips[middle].ID <= target)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	if (low > current)
+	{
+		cursor_ptr->position = low * POSTING_SKIP_INTERVAL;
+		cursor_ptr->offset = skips[low].offset;
+		cursor_ptr->ID = skips[low].ID;
+	}
+	while (cursor_ptr->position < 0 || cursor_ptr->ID < target)
+	{
+		if (!cursor_next(cursor_ptr))
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/* Compare pointers to posting lists by the number of postings, for use with qsort */
+static int list_ptr_compare_size(const void* first_list_ptr, const void* second_list_ptr)
+{
+	return (*(struct Posting_list * const *)first_list_ptr)->size - (*(struct Posting_list * const *)second_list_ptr)->size;
+}
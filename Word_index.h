@@ -0,0 +1,51 @@
+#ifndef WORD_INDEX_H
+#define WORD_INDEX_H
+
+/*
+A Word_index is an opaque type for finding records by the words in their titles.
+A word is a run of letters and digits, compared ignoring case.
+
+For each word the index keeps a posting list of the IDs of the records whose titles
+contain it, in increasing order. The IDs are stored as the difference from the previous
+ID in a variable number of bytes, seven bits to a byte, so that most postings take one
+byte. For every 32nd posting a skip entry holds its ID and position, so that a search
+for the records containing every word can gallop through the skip entries of the longer
+lists instead of decoding all of their postings.
+
+Records with IDs larger than any in the index are added at the end of the lists. Anything
+else rewrites only the differences next to the record's posting, shifts the bytes after them,
+and moves the skip entries after it by one posting. A list is removed when it becomes empty.
+*/
+
+/* incomplete declarations */
+struct Word_index;
+struct Record;
+
+/* A record found by search_Word_index, and how many of the searched words its title contains */
+struct Word_match {
+	int ID;
+	int words;
+};
+
+/* Create an empty Word_index object. */
+struct Word_index* create_Word_index(void);
+
+/* Destroy a Word_index object. */
+void destroy_Word_index(struct Word_index* index_ptr);
+
+/* Add a record to the index. */
+void add_Word_index_record(struct Word_index* index_ptr, const struct Record* record_ptr);
+
+/* Remove a record from the index. */
+void remove_Word_index_record(struct Word_index* index_ptr, const struct Record* record_ptr);
+
+/* Remove all records from the index. */
+void clear_Word_index(struct Word_index* index_ptr);
+
+/* Find the records whose titles contain the words in the text; if require_all is non-zero,
+only records containing every word are found, otherwise records containing any of them.
+Returns an array of the matches in ID order, which the caller must free,
+and sets count_ptr to the number of matches in it. */
+struct Word_match* search_Word_index(struct Word_index* index_ptr, const char* text, int require_all, int* count_ptr);
+
+#endif
@@ -7,5 +7,7 @@ extern int g_string_memory;			/* number of bytes used in C-strings */
 extern int g_Container_count;				/* number of Ordered_containers currently allocated */
 extern int g_Container_items_in_use;		/* number of Ordered_container items currently in use */
 extern int g_Container_items_allocated;		/* number of Ordered_container items currently allocated */
+extern int g_Container_promotions;			/* number of times an Ordered_container has become a tree */
+extern int g_Container_demotions;			/* number of times an Ordered_container has become an array */
 
 #endif
\ No newline at end of file
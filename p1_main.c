@@ -1,12 +1,130 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <limits.h>
 #include "p1_globals.h"
 #include "Collection.h"
 #include "Record.h"
+#include "Journal.h"
+#include "Lexer.h"
+#include "Output.h"
+#include "Server.h"
+#include "Snapshot.h"
+#include "Image.h"
+#include "Checksum.h"
+#include "Title_index.h"
+#include "Word_index.h"
+#include "Rating_index.h"
+#include "Library.h"
+#include "Record_table.h"
 #include "Ordered_container.h"
 #include "Utility.h"
 
+/* The data that commands work on */
+struct Library_data {
+	struct Ordered_container *catalog;
+	struct Library *library;
+	struct Title_index *title_index;
+	struct Word_index *word_index;
+	struct Rating_index *rating_index;
+	struct Record_table *record_table;
+	struct Journal *journal;
+	struct Snapshot *snapshot;	/* the latest background save, until its result is printed */
+};
+
+/* The records a bulk delete removes: those with the medium, or if there is none, the rated ones
+rated below the rating, that are not members of a collection */
+struct Bulk_delete {
+	const char *medium;
+	int rating;
+	int skipped;	/* the number of records selected but kept because they are members */
+};
+
+/* The sections of a save file, each listed in the table after the version with the number of
+records or collections in it, where it starts in the file, its size, and its checksum */
+#define SAVE_SECTIONS 2
+#define SAVE_SECTION_FORMAT "%s %10d %12ld %12ld %08lx\n"
+#define CHECKSUM_BUFFER_SIZE 16384
+static const char* const save_section_names[SAVE_SECTIONS] = { "Records", "Collections" };
+
+struct Save_section {
+	int count;
+	long offset;
+	long size;
+	unsigned long checksum;
+};
+
+/* A record found by a word search, and how many of the words its title contains */
+struct Ranked_record {
+	struct Record *record;
+	int words;
+};
+
+/* A collection with rated members, with their number and the sum of their ratings */
+struct Ranked_collection {
+	struct Collection *collection;
+	int rated;
+	int rating_sum;
+};
+
+/* The collections with rated members, as they are gathered from the catalog */
+struct Ranked_collections {
+	struct Ranked_collection *ranked;
+	int count;
+};
+
+/* Reads the rest of a command from the input and runs it against the data.
+Returns non-zero if the command was quit, which the caller must handle. */
+int run_command(struct Library_data *data, struct Lexer *input, char action, char object);
+
+/* Runs a command for a server client */
+int server_run_command(void* data_ptr, struct Lexer* input, char action, char object);
+
+/* Returns non-zero if the command only reads the data */
+int is_read_only_command(char action, char object);
+
+/* Saves all of the data for a background save */
+void snapshot_save(FILE *outfile, void *data_ptr);
+
+/* Functions that keep the title index up to date as the library changes */
+void title_index_add(void *index_ptr, struct Record *record_ptr);
+void title_index_remove(void *index_ptr, struct Record *record_ptr);
+void title_index_clear(void *index_ptr);
+
+/* Functions that keep the word index up to date as the library changes */
+void word_index_add(void *index_ptr, struct Record *record_ptr);
+void word_index_remove(void *index_ptr, struct Record *record_ptr);
+void word_index_clear(void *index_ptr);
+
+/* Functions that keep the rating index up to date as the library changes */
+void rating_index_add(void *index_ptr, struct Record *record_ptr);
+void rating_index_remove(void *index_ptr, struct Record *record_ptr);
+void rating_index_clear(void *index_ptr);
+
+/* Functions that keep the record table up to date as the library changes */
+void record_table_add(void *table_ptr, struct Record *record_ptr);
+void record_table_remove(void *table_ptr, struct Record *record_ptr);
+void record_table_clear(void *table_ptr);
+void record_table_rate(void *table_ptr, struct Record *record_ptr);
+
+/* Functions that keep the ratings in the statistics of the collections in the catalog up to date
+as the library changes; only the collections a record is a member of are told about it */
+void collection_ratings_add(void *catalog_ptr, struct Record *record_ptr);
+void collection_ratings_remove(void *catalog_ptr, struct Record *record_ptr);
+void collection_ratings_clear(void *catalog_ptr);
+void collection_clear_ratings(void *collection);
+
+/* Adds a collection with rated members to the collections being ranked */
+void collection_rank(void *collection, void *ranked_ptr);
+
+/* Compare ranked collections by average rating, then name, for use with qsort */
+int ranked_collection_compare(const void* first_ranked, const void* second_ranked);
+
+/* Prints the collections with the highest average ratings of their members */
+void print_top_collections(struct Ordered_container *catalog, int count);
+
 /* Safely acquires data ptr of an item ptr */
 void *OC_safe_data_ptr(void *item_ptr);
 
@@ -22,8 +140,14 @@ void collection_print(void* collection);
 /* Used to print all members of a container containing collections */
 void print_all_collections(struct Ordered_container *c_ptr);
 
-/* Checks collection if it contains member */
-int collection_contains(void* collection_ptr, void* record_ptr);
+/* Returns non-zero if the record is a member of any collection */
+int is_collection_member(const struct Record *record_ptr);
+
+/* Returns non-zero if a bulk delete removes the record, counting the members it keeps */
+int bulk_delete_select(struct Record *record_ptr, void *bulk_ptr);
+
+/* Deletes the records a bulk delete selects, and returns the number deleted */
+int bulk_delete(struct Library_data *data, struct Bulk_delete *bulk);
 
 /* Save a collection */
 void collection_save(void* collection, void* current_file);
@@ -32,26 +156,23 @@ void collection_save(void* collection, void* current_file);
 void record_save(void* record, void* current_file);
 
 /* Read in title and get item ptr to record from library */
-void *read_title_get_item_ptr(struct Ordered_container *library_title);
+void *read_title_get_item_ptr(struct Lexer *input, struct Ordered_container *library_title);
 
 /* Read in title and get record from library */
-struct Record * read_title_get_record(struct Ordered_container *library_title);
+struct Record * read_title_get_record(struct Lexer *input, struct Ordered_container *library_title);
 
 /* Read record id and get record from library */
-struct Record * read_id_get_record(struct Ordered_container *library_id);
+struct Record * read_id_get_record(struct Lexer *input, struct Ordered_container *library_id);
 
 /* Read in name and get item ptr to collection from library */
-void *read_name_get_item_ptr(struct Ordered_container *catalog);
+void *read_name_get_item_ptr(struct Lexer *input, struct Ordered_container *catalog);
 
 /* Read in name and get collection from library */
-struct Collection * read_name_get_collection(struct Ordered_container *catalog);
+struct Collection * read_name_get_collection(struct Lexer *input, struct Ordered_container *catalog);
 
 /* Return non-zero if there are no members, 0 if there are members */
 int Collection_not_empty(void* collection_ptr);
 
-/* Used to destroy all records in an Ordered container */
-void record_destroy(void * addr);
-
 /* Used to destroy all collections in an Ordered container */
 void collection_destroy(void * addr);
 
@@ -59,476 +180,1113 @@ void collection_destroy(void * addr);
 void clear_catalog(struct Ordered_container *catalog);
 
 /* Clear library */
-void clear_library(struct Ordered_container *library_title, struct Ordered_container *library_id);
+void clear_library(struct Library_data *data);
 
 /* Clear all data */
-void clear_all(struct Ordered_container *catalog, struct Ordered_container *library_title, struct Ordered_container *library_id);
+void clear_all(struct Library_data *data);
 
 /* Clear all and print a message */
-void clear_all_message(struct Ordered_container *catalog, struct Ordered_container *library_title, struct Ordered_container *library_id);
+void clear_all_message(struct Library_data *data);
 
 /* Reads in filename and open file with given mode */
-FILE * read_filename_open_file(char * mode);
+FILE * read_filename_open_file(struct Lexer *input, char * mode);
+
+/* Reads in text and prints the records whose titles match it in the given kind of search */
+void find_titles(struct Lexer *input, struct Title_index *title_index, int kind);
+
+/* Reads in words and prints the records whose titles contain all or any of them,
+with those containing the most words first, and then those with the highest rating */
+void find_words(struct Lexer *input, struct Library_data *data, int require_all);
+
+/* Compare ranked records by the number of words, then rating, then id, for use with qsort */
+int ranked_record_compare(const void* first_ranked, const void* second_ranked);
+
+/* Loads the given number of records from the file into the library all at once.
+Returns non-zero if invalid data was found. */
+int load_library(struct Lexer *file_input, int records, struct Library_data *data);
+
+/* Saves all of the data to a file in the current save file format; the file must be open for
+reading as well, as the checksums are computed from what was written */
+void save_all(FILE *outfile, struct Ordered_container *catalog, struct Ordered_container *library_title);
+
+/* Writes the table of sections of a save file, whose entries are always the same length */
+void write_section_table(FILE *outfile, const struct Save_section *sections);
+
+/* Computes the checksums of the sections from the bytes in the file.
+Returns non-zero if they could not all be read. */
+int checksum_sections(FILE *file, struct Save_section *sections);
+
+/* Checks the sections of a save file against the checksums in its table, reading the file
+once without changing any data. Returns non-zero if the file is invalid; files of versions
+without the table are not checked. */
+int check_save_file(FILE *infile);
+
+/* Reads the table of sections of a save file, keeping the number of records or collections
+in each section. Returns non-zero if invalid data was found. */
+int load_section_counts(struct Lexer *file_input, int *counts);
+
+/* Loads all of the data in a save file of any format into the empty library and catalog.
+Returns non-zero if invalid data was found. */
+int load_all(struct Lexer *file_input, struct Library_data *data);
+
+/* Applies the entries of a journal file to the data, writing them to the active journal as well.
+Returns non-zero if an invalid entry was found; the entries before it remain applied. */
+int replay_journal(struct Lexer *file_input, struct Library_data *data);
+
+/* Applies a single journal entry for the given command; returns non-zero if the entry is invalid */
+int replay_journal_entry(struct Lexer *file_input, char action, char object, struct Library_data *data);
+
+/* Discards the journal entries once the data has been saved or restored, reporting a failure */
+void checkpoint_journal(struct Journal *journal);
 
 /* Flushes the stream until the next \n */
-void flush_stream(void);
+void flush_stream(struct Lexer *input);
 
 /* Prints message and flushes */
-void message_and_error(char * message);
+void message_and_error(struct Lexer *input, char * message);
 
 /* Prints message and flushes */
 void message_and_error_noflush(char * message);
 
 /* Action Object input error message */
-void action_object_input_error(void);
+void action_object_input_error(struct Lexer *input);
 
 /* Title read error message */
 void title_read_error(void);
 
 /* Integer read error message */
-void integer_read_error(void);
+void integer_read_error(struct Lexer *input);
 
 /* File open error message */
-void file_open_error(void);
+void file_open_error(struct Lexer *input);
 
 /* File invalid error message and closes file */
-void file_invalid_error(FILE *file);
+void file_invalid_error(struct Lexer *input, FILE *file);
 
-int main()
+/* Reports the number of commands run in batch mode, the time taken, and the throughput */
+void report_batch_statistics(long command_count, clock_t start_time);
+
+/* With no arguments, commands are read interactively from standard input. 
+With "-b filename", commands are read in batch mode from the file: no prompts are printed,
+output is only written when the output buffer fills, and the session ends at the end of the file.
+With "-s socket_path", the program is a server that runs the commands of any number of clients
+connected to the Unix domain socket against the same data; "qq" ends only the client's session. */
+int main(int argc, char *argv[])
 {
-	struct Ordered_container *catalog = OC_create_container(collection_compare);
-	struct Ordered_container *library_title = OC_create_container(record_compare_title);
-	struct Ordered_container *library_id = OC_create_container(record_compare_id);
+	struct Library_data data;
+	struct Lexer *input;
+	FILE *command_file = stdin;
+	int batch_mode = 0;
+	int running = 1;
+	long command_count = 0;
+	clock_t start_time = clock();
 	char action, object;
-	while (1)
+	if (argc == 3 && strcmp(argv[1], "-b") == 0)
+	{
+		batch_mode = 1;
+		command_file = fopen(argv[2], "r");
+		if (!command_file)
+		{
+			fprintf(stderr, "Could not open command file!\n");
+			return 1;
+		}
+	}
+	else if (argc != 1 && !(argc == 3 && strcmp(argv[1], "-s") == 0))
+	{
+		fprintf(stderr, "Usage: %s [-b command_file | -s socket_path]\n", argv[0]);
+		return 1;
+	}
+	data.catalog = OC_create_container_backend(collection_compare, OC_ARRAY_BACKEND);
+	/* searching the titles can reorder them, which concurrent readers in server mode must not do */
+	data.library = create_Library(!(argc == 3 && strcmp(argv[1], "-s") == 0));
+	data.title_index = create_Title_index(get_Library_by_title(data.library));
+	data.word_index = create_Word_index();
+	data.rating_index = create_Rating_index();
+	data.record_table = create_Record_table();
+	register_Library_index(data.library, data.title_index, title_index_add, title_index_remove, title_index_clear, 0);
+	register_Library_index(data.library, data.word_index, word_index_add, word_index_remove, word_index_clear, 0);
+	register_Library_index(data.library, data.rating_index, rating_index_add, rating_index_remove, rating_index_clear, 1);
+	register_Library_index(data.library, data.record_table, record_table_add, record_table_remove, record_table_clear, 1);
+	set_Library_index_rate_func(data.library, data.record_table, record_table_rate);
+	register_Library_index(data.library, data.catalog, collection_ratings_add, collection_ratings_remove, collection_ratings_clear, 1);
+	data.journal = NULL;
+	data.snapshot = NULL;
+	if (argc == 3 && strcmp(argv[1], "-s") == 0)
+	{
+		/* only returns if the server could not start */
+		run_server(argv[2], &data, server_run_command, is_read_only_command);
+		fprintf(stderr, "Could not listen on socket!\n");
+		return 1;
+	}
+	input = create_Lexer(command_file, !batch_mode);
+	while (running)
+	{
+		if (!batch_mode)
+		{
+			output_string("\nEnter command: ");
+			output_flush();
+		}
+		if (!lex_char(input, &action) || !lex_char(input, &object))
+		{
+			if (batch_mode)
+			{
+				/* the end of the command file ends the session */
+				clear_all(&data);
+				running = 0;
+			}
+		}
+		else
+		{
+			command_count++;
+			if (run_command(&data, input, action, object))
+			{
+				clear_all_message(&data);
+				output_string("Done\n");
+				running = 0;
+			}
+		}
+	}
+	output_flush();
+	if (data.snapshot)
+	{
+		destroy_Snapshot(data.snapshot);
+	}
+	destroy_Journal(data.journal);
+	destroy_Lexer(input);
+	/* the catalog is an index of the library, so it must outlive it */
+	destroy_Library(data.library);
+	OC_destroy_container(data.catalog);
+	destroy_Title_index(data.title_index);
+	destroy_Word_index(data.word_index);
+	destroy_Rating_index(data.rating_index);
+	destroy_Record_table(data.record_table);
+	if (batch_mode)
 	{
-		printf("\nEnter command: ");
-		if (scanf(" %c %c", &action, &object) == 2)
+		fclose(command_file);
+		report_batch_statistics(command_count, start_time);
+	}
+	return 0;
+}
+
+/* Reads the rest of a command from the input and runs it against the data.
+Returns non-zero if the command was quit, which the caller must handle. */
+int run_command(struct Library_data *data, struct Lexer *input, char action, char object)
+{
+	struct Ordered_container *catalog = data->catalog;
+	struct Ordered_container *library_title = get_Library_by_title(data->library);
+	struct Ordered_container *library_id = get_Library_by_ID(data->library);
+	switch (action)
+	{
+		case 'f': /* find (records only) */
 		{
-			switch (action)
+			switch (object)
 			{
-				case 'f': /* find (records only) */
+				case 'r': /* find record */
 				{
-					switch (object)
+					struct Record *item = read_title_get_record(input, library_title);
+					if (item)
 					{
-						case 'r': /* find record */
-						{
-							struct Record *item = read_title_get_record(library_title);
-							if (item)
-							{
-								print_Record(item);
-							}
-							break;
-						}
-						default:
-						{
-							action_object_input_error();
-							break;
-						}
+						print_Record(item);
+					}
+					break;
+				}
+				case 's': /* find records with titles containing the text */
+				{
+					find_titles(input, data->title_index, TITLE_SEARCH_CONTAINS);
+					break;
+				}
+				case 'i': /* find records with titles containing the text, ignoring case */
+				{
+					find_titles(input, data->title_index, TITLE_SEARCH_IGNORE_CASE);
+					break;
+				}
+				case 'e': /* find records with titles one edit from the text */
+				{
+					find_titles(input, data->title_index, TITLE_SEARCH_SIMILAR);
+					break;
+				}
+				case 'w': /* find records with titles containing any of the words */
+				{
+					find_words(input, data, 0);
+					break;
+				}
+				case 'a': /* find records with titles containing all of the words */
+				{
+					find_words(input, data, 1);
+					break;
+				}
+				default:
+				{
+					action_object_input_error(input);
+					break;
+				}
+			}
+			break;
+		}
+		case 'p': /* print */
+		{
+			switch (object)
+			{
+				case 'r': /* print record */
+				{
+					struct Record *item = read_id_get_record(input, library_id);
+					if (!item)
+					{
+						break;
 					}
+					print_Record(item);
 					break;
 				}
-				case 'p': /* print */
+				case 'c': /* print collection */
 				{
-					switch (object)
+					struct Collection *collection = read_name_get_collection(input, catalog);
+					if (!collection)
 					{
-						case 'r': /* print record */
+						break;
+					}
+					print_Collection(collection);
+					break;
+				}
+				case 's': /* print statistics of a collection */
+				{
+					struct Collection *collection = read_name_get_collection(input, catalog);
+					if (!collection)
+					{
+						break;
+					}
+					print_Collection_statistics(collection);
+					break;
+				}
+				case 'T': /* print the collections with the highest average ratings */
+				{
+					int count;
+					if (!lex_int(input, &count))
+					{
+						integer_read_error(input);
+						break;
+					}
+					if (count < 1)
+					{
+						message_and_error(input, "Count is out of range!\n");
+						break;
+					}
+					print_top_collections(catalog, count);
+					break;
+				}
+				case 'L': /* print library */
+				{
+					if (!OC_empty(library_title))
+					{
+						output_format("Library contains %d records:\n", OC_get_size(library_title));
+						OC_apply(library_title, record_print);
+					}
+					else
+					{
+						output_string("Library is empty\n");
+					}
+					break;
+				}
+				case 'C': /* print catalog */
+				{
+					if (!OC_empty(catalog))
+					{
+						output_format("Catalog contains %d collections:\n", OC_get_size(catalog));
+						print_all_collections(catalog);
+					}
+					else
+					{
+						output_string("Catalog is empty\n");
+					}
+					break;
+				}
+				case 'a': /* print memory allocations */
+				{
+					output_string("Memory allocations:\n");
+					output_format("Records: %d\n", OC_get_size(library_title));
+					output_format("Collections: %d\n", OC_get_size(catalog));
+					output_format("Containers: %d\n", g_Container_count);
+					output_format("Container items in use: %d\n", g_Container_items_in_use);
+					output_format("Container items allocated: %d\n", g_Container_items_allocated);
+					if (g_Container_promotions || g_Container_demotions)
+					{
+						output_format("Container promotions to trees: %d\n", g_Container_promotions);
+						output_format("Container demotions to arrays: %d\n", g_Container_demotions);
+					}
+					output_format("C-strings: %d bytes total\n", g_string_memory);
+					break;
+				}
+				case 'B': /* print background save status */
+				{
+					long bytes_written;
+					int status;
+					if (!data->snapshot)
+					{
+						output_string("No background save\n");
+						break;
+					}
+					status = get_Snapshot_status(data->snapshot, &bytes_written);
+					if (status == SNAPSHOT_RUNNING)
+					{
+						output_format("Background save running: %ld bytes written\n", bytes_written);
+						break;
+					}
+					if (status == SNAPSHOT_COMPLETED)
+					{
+						output_format("Background save completed: %ld bytes written\n", bytes_written);
+					}
+					else
+					{
+						output_string("Background save failed\n");
+					}
+					destroy_Snapshot(data->snapshot);
+					data->snapshot = NULL;
+					break;
+				}
+				case 't': /* print the highest rated records */
+				{
+					int count, found;
+					if (!lex_int(input, &count))
+					{
+						integer_read_error(input);
+						break;
+					}
+					if (count < 1)
+					{
+						message_and_error(input, "Count is out of range!\n");
+						break;
+					}
+					found = get_Rating_index_count(data->rating_index, RATING_MIN, INT_MAX);
+					if (found == 0)
+					{
+						output_string("No rated records\n");
+						break;
+					}
+					output_format("Top %d records:\n", found < count ? found : count);
+					apply_Rating_index(data->rating_index, RATING_MIN, INT_MAX, count, record_print);
+					break;
+				}
+				case 'g': /* print records with ratings in a range */
+				{
+					int low, high, found;
+					if (!lex_int(input, &low) || !lex_int(input, &high))
+					{
+						integer_read_error(input);
+						break;
+					}
+					found = get_Rating_index_count(data->rating_index, low, high);
+					if (found == 0)
+					{
+						output_string("No records found\n");
+						break;
+					}
+					output_format("Found %d records:\n", found);
+					apply_Rating_index(data->rating_index, low, high, found, record_print);
+					break;
+				}
+				case 'u': /* print the number of unrated records */
+				{
+					output_format("Unrated records: %d\n", get_Rating_index_count(data->rating_index, 0, 0));
+					break;
+				}
+				case 'k': /* print the number of records rated at least a rating */
+				{
+					int rating;
+					if (!lex_int(input, &rating))
+					{
+						integer_read_error(input);
+						break;
+					}
+					if (rating < RATING_MIN || rating > RATING_MAX)
+					{
+						message_and_error(input, "Rating is out of range!\n");
+						break;
+					}
+					output_format("Records rated %d or higher: %d\n", rating, count_Record_table_rated(data->record_table, rating));
+					break;
+				}
+				case 'm': /* print records with a medium */
+				{
+					char medium[MEDIUM_BUFFER_SIZE];
+					struct Record **found;
+					int count, i;
+					if (!lex_word(input, medium, MEDIUM_BUFFER_SIZE))
+					{
+						title_read_error();
+						break;
+					}
+					found = search_Record_table_medium(data->record_table, medium, &count);
+					if (count > 0)
+					{
+						output_format("Found %d records:\n", count);
+						for (i = 0; i < count; i++)
 						{
-							struct Record *item = read_id_get_record(library_id);
-							if (!item)
-							{
-								break;
-							}
-							print_Record(item);
-							break;
+							print_Record(found[i]);
 						}
-						case 'c': /* print collection */
+					}
+					else
+					{
+						output_string("No records found\n");
+					}
+					free(found);
+					break;
+				}
+				default:
+				{
+					action_object_input_error(input);
+					break;
+				}
+			}
+			break;
+		}
+		case 'm': /* modify (rating only) */
+		{
+			switch (object)
+			{
+				case 'r': /* modify rating of a record */
+				{
+					int rating;
+					struct Record *item = read_id_get_record(input, library_id);
+					if (!lex_int(input, &rating))
+					{
+						integer_read_error(input);
+						break;
+					}
+					if (rating < RATING_MIN || rating > RATING_MAX)
+					{
+						message_and_error(input, "Rating is out of range!\n");
+						break;
+					}
+					modify_Library_record_rating(data->library, item, rating);
+					journal_entry(data->journal, "mr %d %d\n", get_Record_ID(item), rating);
+					output_format("Rating for record %d changed to %d\n", get_Record_ID(item), rating);
+					break;
+				}
+				default:
+				{
+					action_object_input_error(input);
+					break;
+				}
+			}
+			break;
+		}
+		case 'a': /* add */
+		{
+			switch (object)
+			{
+				case 'r': /* add record */
+				{
+					char medium[MEDIUM_BUFFER_SIZE];
+					char title_buffer[TITLE_BUFFER_SIZE];
+					char *title;
+					struct Record *record;
+					if (!lex_word(input, medium, MEDIUM_BUFFER_SIZE))
+					{
+						title_read_error();
+						break;
+					}
+					title = read_title(title_buffer, input);
+					if (!title)
+					{
+						title_read_error();
+						break;
+					}
+					if (OC_find_item_arg(library_title, title, record_title_compare) != 0)
+					{
+						message_and_error_noflush("Library already has a record with this title!\n");
+						break;
+					}
+					record = create_Record(medium, title);
+					insert_Library_record(data->library, record);
+					journal_record_entry(data->journal, record);
+					output_format("Record %d added\n", get_Record_ID(record));
+					break;
+				}
+				case 'c': /* add collection */
+				{
+					char name[NAME_BUFFER_SIZE];
+					struct Collection *collection;
+					if (!lex_word(input, name, NAME_BUFFER_SIZE))
+					{
+						title_read_error();
+						break;
+					}
+					if (OC_find_item_arg(catalog, name, collection_name_compare) != 0)
+					{
+						message_and_error(input, "Catalog already has a collection with this name!\n");
+						break;
+					}
+					collection = create_Collection(name);
+					OC_insert(catalog, collection);
+					journal_entry(data->journal, "ac %s\n", name);
+					output_format("Collection %s added\n", name);
+					break;
+				}
+				case 'm': /* add record to collection */
+				{
+					struct Collection *collection = read_name_get_collection(input, catalog);
+					struct Record *record;
+					if (!collection)
+					{
+						break;
+					}
+					record = read_id_get_record(input, library_id);
+					if (!record)
+					{
+						break;
+					}
+					if (!add_Collection_member(collection, record))
+					{
+						journal_entry(data->journal, "am %s %d\n", get_Collection_name(collection), get_Record_ID(record));
+						output_format("Member %d %s added\n", get_Record_ID(record), get_Record_title(record));
+					}
+					else
+					{
+						message_and_error(input, "Record is already a member in the collection!\n");
+					}
+					break;
+				}
+				default:
+				{
+					action_object_input_error(input);
+					break;
+				}
+			}
+			break;
+		}
+		case 'd': /* delete */
+		{
+			switch (object)
+			{
+				case 'r': /* delete record */
+				{
+					void *item = read_title_get_item_ptr(input, library_title);
+					struct Record *record = OC_safe_data_ptr(item);
+					if (!item)
+					{
+						break;
+					}
+					if (is_collection_member(record))
+					{
+						message_and_error_noflush("Cannot delete a record that is a member of a collection!\n");
+						break;
+					}
+					journal_entry(data->journal, "dr %d\n", get_Record_ID(record));
+					output_format("Record %d %s deleted\n", get_Record_ID(record), get_Record_title(record));
+					erase_Library_record(data->library, item);
+					break;
+				}
+				case 'c': /* delete collection */
+				{
+					void *item = read_name_get_item_ptr(input, catalog);
+					struct Collection *collection;
+					if (!item)
+					{
+						break;
+					}
+					collection = OC_get_data_ptr(item);
+					OC_delete_item(catalog, item);
+					journal_entry(data->journal, "dc %s\n", get_Collection_name(collection));
+					output_format("Collection %s deleted\n", get_Collection_name(collection));
+					destroy_Collection(collection);
+					break;
+				}
+				case 'm': /* delete record from collection */
+				{
+					struct Collection *collection = read_name_get_collection(input, catalog);
+					struct Record *record;
+					if (!collection)
+					{
+						break;
+					}
+					record = read_id_get_record(input, library_id);
+					if (!record)
+					{
+						break;
+					}
+					if (!remove_Collection_member(collection, record))
+					{
+						journal_entry(data->journal, "dm %s %d\n", get_Collection_name(collection), get_Record_ID(record));
+						output_format("Member %d %s deleted\n", get_Record_ID(record), get_Record_title(record));
+					}
+					else
+					{
+						message_and_error(input, "Record is not a member in the collection!\n");
+					}
+					break;
+				}
+				case 'K': /* delete all records rated below a rating */
+				case 'M': /* delete all records with a medium */
+				{
+					char medium[MEDIUM_BUFFER_SIZE];
+					struct Bulk_delete bulk;
+					int count;
+					if (object == 'K')
+					{
+						if (!lex_int(input, &bulk.rating))
 						{
-							struct Collection *collection = read_name_get_collection(catalog);
-							if (!collection)
-							{
-								break;
-							}
-							print_Collection(collection);
+							integer_read_error(input);
 							break;
 						}
-						case 'L': /* print library */
+						if (bulk.rating < RATING_MIN || bulk.rating > RATING_MAX)
 						{
-							if (!OC_empty(library_title))
-							{
-								printf("Library contains %d records:\n", OC_get_size(library_title));
-								OC_apply(library_title, record_print);
-							}
-							else
-							{
-								printf("Library is empty\n");
-							}
+							message_and_error(input, "Rating is out of range!\n");
 							break;
 						}
-						case 'C': /* print catalog */
+						bulk.medium = NULL;
+					}
+					else
+					{
+						if (!lex_word(input, medium, MEDIUM_BUFFER_SIZE))
 						{
-							if (!OC_empty(catalog))
-							{
-								printf("Catalog contains %d collections:\n", OC_get_size(catalog));
-								print_all_collections(catalog);
-							}
-							else
-							{
-								printf("Catalog is empty\n");
-							}
+							title_read_error();
 							break;
 						}
-						case 'a': /* print memory allocations */
+						bulk.medium = medium;
+					}
+					count = bulk_delete(data, &bulk);
+					if (count > 0)
+					{
+						if (object == 'K')
 						{
-							printf("Memory allocations:\n");
-							printf("Records: %d\n", OC_get_size(library_title));
-							printf("Collections: %d\n", OC_get_size(catalog));
-							printf("Containers: %d\n", g_Container_count);
-							printf("Container items in use: %d\n", g_Container_items_in_use);
-							printf("Container items allocated: %d\n", g_Container_items_allocated);
-							printf("C-strings: %d bytes total\n", g_string_memory);
-							break;
+							journal_entry(data->journal, "dK %d\n", bulk.rating);
 						}
-						default:
+						else
 						{
-							action_object_input_error();
-							break;
+							journal_entry(data->journal, "dM %s\n", medium);
 						}
 					}
+					output_format("%d records deleted\n", count);
+					if (bulk.skipped > 0)
+					{
+						output_format("%d records in collections not deleted\n", bulk.skipped);
+					}
+					break;
+				}
+				default:
+				{
+					action_object_input_error(input);
 					break;
 				}
-				case 'm': /* modify (rating only) */
+			}
+			break;
+		}
+		case 'c': /* clear */
+		{
+			switch (object)
+			{
+				case 'L': /* clear library */
 				{
-					switch (object)
+					if (OC_apply_if(catalog, Collection_not_empty))
 					{
-						case 'r': /* modify rating of a record */
-						{
-							int rating;
-							struct Record *item = read_id_get_record(library_id);
-							if (scanf("%d", &rating) != 1)
-							{
-								integer_read_error();
-								break;
-							}
-							if (rating < RATING_MIN || rating > RATING_MAX)
-							{
-								message_and_error("Rating is out of range!\n");
-								break;
-							}
-							set_Record_rating(item, rating);
-							printf("Rating for record %d changed to %d\n", get_Record_ID(item), rating);
-							break;
-						}
-						default:
-						{
-							action_object_input_error();
-							break;
-						}
+						message_and_error(input, "Cannot clear all records unless all collections are empty!\n");
+						break;
 					}
+					clear_library(data);
+					journal_entry(data->journal, "cL\n");
+					output_string("All records deleted\n");
 					break;
 				}
-				case 'a': /* add */
+				case 'C': /* clear catalog */
 				{
-					switch (object)
+					clear_catalog(catalog);
+					journal_entry(data->journal, "cC\n");
+					output_string("All collections deleted\n");
+					break;
+				}
+				case 'A': /* clear all */
+				{
+					clear_all_message(data);
+					journal_entry(data->journal, "cA\n");
+					break;
+				}
+				default:
+				{
+					action_object_input_error(input);
+					break;
+				}
+			}
+			break;
+		}
+		case 's': /* save */
+		{
+			switch (object)
+			{
+				case 'A': /* save all */
+				{
+					FILE *outfile = read_filename_open_file(input, "w+");
+					if (!outfile)
 					{
-						case 'r': /* add record */
-						{
-							char medium[MEDIUM_BUFFER_SIZE];
-							char title_buffer[TITLE_BUFFER_SIZE];
-							char *title;
-							struct Record *record;
-							if (scanf(MEDIUM_SCAN_BUFFER, medium) != 1)
-							{
-								title_read_error();
-								break;
-							}
-							title = read_title(title_buffer, stdin);
-							if (!title)
-							{
-								title_read_error();
-								break;
-							}
-							if (OC_find_item_arg(library_title, title, record_title_compare) != 0)
-							{
-								message_and_error_noflush("Library already has a record with this title!\n");
-								break;
-							}
-							record = create_Record(medium, title);
-							OC_insert(library_title, record);
-							OC_insert(library_id, record);
-							printf("Record %d added\n", get_Record_ID(record));
-							break;
-						}
-						case 'c': /* add collection */
-						{
-							char name[NAME_BUFFER_SIZE];
-							struct Collection *collection;
-							if (scanf(NAME_SCAN_BUFFER, name) != 1)
-							{
-								title_read_error();
-								break;
-							}
-							if (OC_find_item_arg(catalog, name, collection_name_compare) != 0)
-							{
-								message_and_error("Catalog already has a collection with this name!\n");
-								break;
-							}
-							collection = create_Collection(name);
-							OC_insert(catalog, collection);
-							printf("Collection %s added\n", name);
-							break;
-						}
-						case 'm': /* add record to collection */
-						{
-							struct Collection *collection = read_name_get_collection(catalog);
-							struct Record *record;
-							if (!collection)
-							{
-								break;
-							}
-							record = read_id_get_record(library_id);
-							if (!record)
-							{
-								break;
-							}
-							if (!add_Collection_member(collection, record))
-							{
-								printf("Member %d %s added\n", get_Record_ID(record), get_Record_title(record));
-							}
-							else
-							{
-								message_and_error("Record is already a member in the collection!\n");
-							}
-							break;
-						}
-						default:
-						{
-							action_object_input_error();
-							break;
-						}
+						break;
 					}
+					save_all(outfile, catalog, library_title);
+					fclose(outfile);
+					checkpoint_journal(data->journal);
+					output_string("Data saved\n");
 					break;
 				}
-				case 'd': /* delete */
+				case 'B': /* save all in the background */
 				{
-					switch (object)
+					FILE *outfile;
+					struct Snapshot *snapshot;
+					long bytes_written;
+					if (data->snapshot && get_Snapshot_status(data->snapshot, &bytes_written) == SNAPSHOT_RUNNING)
 					{
-						case 'r': /* delete record */
-						{
-							void *item = read_title_get_item_ptr(library_title);
-							struct Record *record = OC_safe_data_ptr(item);
-							if (!item)
-							{
-								break;
-							}
-							if (OC_apply_if_arg(catalog, collection_contains, record))
-							{
-								message_and_error_noflush("Cannot delete a record that is a member of a collection!\n");
-								break;
-							}
-							OC_delete_item(library_title, item);
-							OC_delete_item(library_id, OC_find_item(library_id, record));
-							printf("Record %d %s deleted\n", get_Record_ID(record), get_Record_title(record));
-							destroy_Record(record);
-							break;
-						}
-						case 'c': /* delete collection */
-						{
-							void *item = read_name_get_item_ptr(catalog);
-							struct Collection *collection;
-							if (!item)
-							{
-								break;
-							}
-							collection = OC_get_data_ptr(item);
-							OC_delete_item(catalog, item);
-							printf("Collection %s deleted\n", get_Collection_name(collection));
-							destroy_Collection(collection);
-							break;
-						}
-						case 'm': /* delete record from collection */
-						{
-							struct Collection *collection = read_name_get_collection(catalog);
-							struct Record *record;
-							if (!collection)
-							{
-								break;
-							}
-							record = read_id_get_record(library_id);
-							if (!record)
-							{
-								break;
-							}
-							if (!remove_Collection_member(collection, record))
-							{
-								printf("Member %d %s deleted\n", get_Record_ID(record), get_Record_title(record));
-							}
-							else
-							{
-								message_and_error("Record is not a member in the collection!\n");
-							}
-							break;
-						}
-						default:
-						{
-							action_object_input_error();
-							break;
-						}
+						message_and_error(input, "A background save is already running!\n");
+						break;
+					}
+					outfile = read_filename_open_file(input, "w+");
+					if (!outfile)
+					{
+						break;
+					}
+					snapshot = create_Snapshot(outfile, snapshot_save, data);
+					if (!snapshot)
+					{
+						fclose(outfile);
+						message_and_error_noflush("Could not start background save!\n");
+						break;
 					}
+					if (data->snapshot)
+					{
+						destroy_Snapshot(data->snapshot);
+					}
+					data->snapshot = snapshot;
+					output_string("Background save started\n");
 					break;
 				}
-				case 'c': /* clear */
+				case 'J': /* start journal */
 				{
-					switch (object)
+					char filename[FILE_BUFFER_SIZE];
+					struct Journal *new_journal;
+					if (!lex_word(input, filename, FILE_BUFFER_SIZE) || !(new_journal = create_Journal(filename)))
 					{
-						case 'L': /* clear library */
-						{
-							if (OC_apply_if(catalog, Collection_not_empty))
-							{
-								message_and_error("Cannot clear all records unless all collections are empty!\n");
-								break;
-							}
-							clear_library(library_title, library_id);
-							printf("All records deleted\n");
-							break;
-						}
-						case 'C': /* clear catalog */
-						{
-							clear_catalog(catalog);
-							printf("All collections deleted\n");
-							break;
-						}
-						case 'A': /* clear all */
-						{
-							clear_all_message(catalog, library_title, library_id);
-							break;
-						}
-						default:
-						{
-							action_object_input_error();
-							break;
-						}
+						file_open_error(input);
+						break;
 					}
+					destroy_Journal(data->journal);
+					data->journal = new_journal;
+					output_string("Journal started\n");
 					break;
 				}
-				case 's': /* save */
+				case 'I': /* save all to an image file */
 				{
-					switch (object)
+					char filename[FILE_BUFFER_SIZE];
+					if (!lex_word(input, filename, FILE_BUFFER_SIZE) || save_Image(filename, library_title, catalog))
 					{
-						case 'A': /* save all */
-						{
-							FILE *outfile = read_filename_open_file("w");
-							if (!outfile)
-							{
-								break;
-							}
-							fprintf(outfile, "%d\n", OC_get_size(library_title));
-							OC_apply_arg(library_title, record_save, outfile);
-							fprintf(outfile, "%d\n", OC_get_size(catalog));
-							OC_apply_arg(catalog, collection_save, outfile);
-							fclose(outfile);
-							printf("Data saved\n");
-							break;
-						}
-						default:
-						{
-							action_object_input_error();
-							break;
-						}
+						file_open_error(input);
+						break;
 					}
+					checkpoint_journal(data->journal);
+					output_string("Data saved\n");
+					break;
+				}
+				default:
+				{
+					action_object_input_error(input);
 					break;
 				}
-				case 'r': /* restore */
+			}
+			break;
+		}
+		case 'r': /* restore */
+		{
+			switch (object)
+			{
+				case 'A': /* restore all */
 				{
-					switch (object)
+					FILE *infile = read_filename_open_file(input, "r");
+					struct Lexer *file_input;
+					int is_invalid;
+					if (!infile)
 					{
-						case 'A': /* restore all */
-						{
-							int records, collections;
-							FILE *infile = read_filename_open_file("r");
-							if (!infile)
-							{
-								break;
-							}
-							clear_all(catalog, library_title, library_id);
-							if (fscanf(infile, "%d\n", &records) != 1)
-							{
-								file_invalid_error(infile);
-								break;
-							}
-							for (; records > 0; records--)
-							{
-								struct Record *record = load_Record(infile);
-								if (!record)
-								{
-									/* error loading a record */
-									break;
-								}
-								OC_insert(library_title, record);
-								OC_insert(library_id, record);
-							}
-							if (records > 0 || fscanf(infile, "%d\n", &collections) != 1)
-							{
-								file_invalid_error(infile);
-								clear_all(catalog, library_title, library_id);
-								break;
-							}
-							for (; collections > 0; collections--)
-							{
-								struct Collection *collection = load_Collection(infile, library_title);
-								if (!collection)
-								{
-									/* error loading a collection */
-									break;
-								}
-								OC_insert(catalog, collection);
-							}
-							if (collections > 0)
-							{
-								file_invalid_error(infile);
-								clear_all(catalog, library_title, library_id);
-								break;
-							}
-							printf("Data loaded\n");
-							break;
-						}
-						default:
-						{
-							action_object_input_error();
-							break;
-						}
+						break;
+					}
+					/* a damaged file is found before anything is cleared, so the data is kept */
+					if (check_save_file(infile))
+					{
+						file_invalid_error(input, infile);
+						break;
 					}
+					rewind(infile);
+					clear_all(data);
+					file_input = create_Lexer(infile, 0);
+					is_invalid = load_all(file_input, data);
+					destroy_Lexer(file_input);
+					if (is_invalid)
+					{
+						file_invalid_error(input, infile);
+						clear_all(data);
+						journal_entry(data->journal, "cA\n");
+						break;
+					}
+					fclose(infile);
+					checkpoint_journal(data->journal);
+					output_string("Data loaded\n");
 					break;
 				}
-				case 'q': /* quit */
+				case 'I': /* restore all from an image file */
 				{
-					switch (object)
+					char filename[FILE_BUFFER_SIZE];
+					struct Image *image;
+					if (!lex_word(input, filename, FILE_BUFFER_SIZE) || !(image = open_Image(filename)))
 					{
-						case 'q': /* quit */
-						{
-							clear_all_message(catalog, library_title, library_id);
-							printf("Done\n");
-							OC_destroy_container(catalog);
-							OC_destroy_container(library_title);
-							OC_destroy_container(library_id);
-							return 0;
-						}
-						default:
-						{
-							action_object_input_error();
-							break;
-						}
+						file_open_error(input);
+						break;
+					}
+					/* a damaged image is found before anything is cleared, so the data is kept */
+					if (check_Image(image))
+					{
+						close_Image(image);
+						message_and_error(input, "Invalid data found in file!\n");
+						break;
+					}
+					clear_all(data);
+					load_Image(image, data->library, catalog);
+					close_Image(image);
+					checkpoint_journal(data->journal);
+					output_string("Data loaded\n");
+					break;
+				}
+				case 'J': /* replay journal */
+				{
+					FILE *infile = read_filename_open_file(input, "r");
+					struct Lexer *file_input;
+					int is_invalid;
+					if (!infile)
+					{
+						break;
+					}
+					/* replayed entries are journaled again, so the journal being written would never end */
+					if (is_Journal_file(data->journal, infile))
+					{
+						fclose(infile);
+						message_and_error(input, "Cannot replay the journal being written!\n");
+						break;
 					}
+					file_input = create_Lexer(infile, 0);
+					is_invalid = replay_journal(file_input, data);
+					destroy_Lexer(file_input);
+					if (is_invalid)
+					{
+						file_invalid_error(input, infile);
+						break;
+					}
+					fclose(infile);
+					output_string("Journal replayed\n");
 					break;
 				}
 				default:
 				{
-					action_object_input_error();
+					action_object_input_error(input);
 					break;
 				}
 			}
+			break;
 		}
+		case 'q': /* quit */
+		{
+			switch (object)
+			{
+				case 'q': /* quit */
+				{
+					return 1;
+				}
+				default:
+				{
+					action_object_input_error(input);
+					break;
+				}
+			}
+			break;
+		}
+		default:
+		{
+			action_object_input_error(input);
+			break;
+		}
+	}
+	return 0;
+}
+
+/* Runs a command for a server client */
+int server_run_command(void* data_ptr, struct Lexer* input, char action, char object)
+{
+	return run_command(data_ptr, input, action, object);
+}
+
+/* Returns non-zero if the command only reads the data */
+int is_read_only_command(char action, char object)
+{
+	/* printing the result of a background save forgets the save */
+	return action == 'f' || (action == 'p' && object != 'B');
+}
+
+/* Saves all of the data for a background save */
+void snapshot_save(FILE *outfile, void *data_ptr)
+{
+	struct Library_data *data = data_ptr;
+	save_all(outfile, data->catalog, get_Library_by_title(data->library));
+}
+
+/* Functions that keep the title index up to date as the library changes */
+void title_index_add(void *index_ptr, struct Record *record_ptr)
+{
+	add_Title_index_record(index_ptr, record_ptr);
+}
+
+void title_index_remove(void *index_ptr, struct Record *record_ptr)
+{
+	remove_Title_index_record(index_ptr, record_ptr);
+}
+
+void title_index_clear(void *index_ptr)
+{
+	clear_Title_index(index_ptr);
+}
+
+/* Functions that keep the word index up to date as the library changes */
+void word_index_add(void *index_ptr, struct Record *record_ptr)
+{
+	add_Word_index_record(index_ptr, record_ptr);
+}
+
+void word_index_remove(void *index_ptr, struct Record *record_ptr)
+{
+	remove_Word_index_record(index_ptr, record_ptr);
+}
+
+void word_index_clear(void *index_ptr)
+{
+	clear_Word_index(index_ptr);
+}
+
+/* Functions that keep the rating index up to date as the library changes */
+void rating_index_add(void *index_ptr, struct Record *record_ptr)
+{
+	add_Rating_index_record(index_ptr, record_ptr);
+}
+
+void rating_index_remove(void *index_ptr, struct Record *record_ptr)
+{
+	remove_Rating_index_record(index_ptr, record_ptr);
+}
+
+void rating_index_clear(void *index_ptr)
+{
+	clear_Rating_index(index_ptr);
+}
+
+/* Functions that keep the record table up to date as the library changes */
+void record_table_add(void *table_ptr, struct Record *record_ptr)
+{
+	add_Record_table_record(table_ptr, record_ptr);
+}
+
+void record_table_remove(void *table_ptr, struct Record *record_ptr)
+{
+	remove_Record_table_record(table_ptr, record_ptr);
+}
+
+void record_table_clear(void *table_ptr)
+{
+	clear_Record_table(table_ptr);
+}
+
+void record_table_rate(void *table_ptr, struct Record *record_ptr)
+{
+	rate_Record_table_record(table_ptr, record_ptr);
+}
+
+/* Functions that keep the ratings in the statistics of the collections in the catalog up to date
+as the library changes; only the collections a record is a member of are told about it */
+void collection_ratings_add(void *catalog_ptr, struct Record *record_ptr)
+{
+	struct Collection *const *collections;
+	int count = get_Record_memberships(record_ptr, &collections);
+	int i;
+	for (i = 0; i < count; i++)
+	{
+		add_Collection_member_rating(collections[i], record_ptr);
+	}
+}
+
+void collection_ratings_remove(void *catalog_ptr, struct Record *record_ptr)
+{
+	struct Collection *const *collections;
+	int count = get_Record_memberships(record_ptr, &collections);
+	int i;
+	for (i = 0; i < count; i++)
+	{
+		remove_Collection_member_rating(collections[i], record_ptr);
+	}
+}
+
+void collection_ratings_clear(void *catalog_ptr)
+{
+	/* the ratings are added back as the library gives the index each record again */
+	OC_apply(catalog_ptr, collection_clear_ratings);
+}
+
+void collection_clear_ratings(void *collection)
+{
+	clear_Collection_ratings((struct Collection *)collection);
+}
+
+/* Adds a collection with rated members to the collections being ranked */
+void collection_rank(void *collection, void *ranked_ptr)
+{
+	struct Ranked_collections *ranked = ranked_ptr;
+	struct Ranked_collection *entry = &ranked->ranked[ranked->count];
+	entry->rated = get_Collection_rated(collection, &entry->rating_sum);
+	if (entry->rated > 0)
+	{
+		entry->collection = collection;
+		ranked->count++;
+	}
+}
+
+/* Compare ranked collections by average rating, then name, for use with qsort */
+int ranked_collection_compare(const void* first_ranked, const void* second_ranked)
+{
+	const struct Ranked_collection *first = first_ranked;
+	const struct Ranked_collection *second = second_ranked;
+	/* the averages are compared without dividing, as first_sum / first_rated < second_sum / second_rated */
+	long first_scaled = (long)first->rating_sum * second->rated;
+	long second_scaled = (long)second->rating_sum * first->rated;
+	if (first_scaled != second_scaled)
+	{
+		return first_scaled < second_scaled ? 1 : -1;
+	}
+	return strcmp(get_Collection_name(first->collection), get_Collection_name(second->collection));
+}
+
+/* Prints the collections with the highest average ratings of their members */
+void print_top_collections(struct Ordered_container *catalog, int count)
+{
+	struct Ranked_collections ranked;
+	int i;
+	ranked.ranked = malloc((OC_get_size(catalog) + 1) * sizeof(struct Ranked_collection));
+	ranked.count = 0;
+	OC_apply_arg(catalog, collection_rank, &ranked);
+	if (ranked.count == 0)
+	{
+		output_string("No collections with rated members\n");
+		free(ranked.ranked);
+		return;
+	}
+	qsort(ranked.ranked, ranked.count, sizeof(struct Ranked_collection), ranked_collection_compare);
+	if (count > ranked.count)
+	{
+		count = ranked.count;
+	}
+	output_format("Top %d collections:\n", count);
+	for (i = 0; i < count; i++)
+	{
+		struct Ranked_collection *entry = &ranked.ranked[i];
+		output_format("%s %.2f average of %d rated of %d members\n", get_Collection_name(entry->collection),
+			(double)entry->rating_sum / entry->rated, entry->rated, get_Collection_size(entry->collection));
 	}
+	free(ranked.ranked);
 }
 
 /* Safely acquires data ptr of an item ptr */
@@ -565,10 +1323,36 @@ void print_all_collections(struct Ordered_container *c_ptr)
 	OC_apply(c_ptr, collection_print);
 }
 
-/* Checks collection if it contains member */
-int collection_contains(void* collection_ptr, void* record_ptr)
+/* Returns non-zero if the record is a member of any collection */
+int is_collection_member(const struct Record *record_ptr)
 {
-	return is_Collection_member_present((struct Collection *) collection_ptr, (struct Record *)record_ptr);
+	struct Collection *const *collections;
+	return get_Record_memberships(record_ptr, &collections) > 0;
+}
+
+/* Returns non-zero if a bulk delete removes the record, counting the members it keeps */
+int bulk_delete_select(struct Record *record_ptr, void *bulk_ptr)
+{
+	struct Bulk_delete *bulk = bulk_ptr;
+	if (bulk->medium ? strcmp(get_Record_medium(record_ptr), bulk->medium) != 0
+		: get_Record_rating(record_ptr) < RATING_MIN || get_Record_rating(record_ptr) >= bulk->rating)
+	{
+		return 0;
+	}
+	/* as with a single record, a member of a collection cannot be deleted */
+	if (is_collection_member(record_ptr))
+	{
+		bulk->skipped++;
+		return 0;
+	}
+	return 1;
+}
+
+/* Deletes the records a bulk delete selects, and returns the number deleted */
+int bulk_delete(struct Library_data *data, struct Bulk_delete *bulk)
+{
+	bulk->skipped = 0;
+	return erase_Library_records_if(data->library, bulk_delete_select, bulk);
 }
 
 /* Save a collection */
@@ -584,10 +1368,10 @@ void record_save(void* record, void* current_file)
 }
 
 /* Read in title and get item ptr to record from library */
-void *read_title_get_item_ptr(struct Ordered_container *library_title)
+void *read_title_get_item_ptr(struct Lexer *input, struct Ordered_container *library_title)
 {
 	char title_buffer[TITLE_BUFFER_SIZE];
-	char *title = read_title(title_buffer, stdin);
+	char *title = read_title(title_buffer, input);
 	void *item;
 	if (!title)
 	{
@@ -603,51 +1387,51 @@ void *read_title_get_item_ptr(struct Ordered_container *library_title)
 }
 
 /* Read in title and get record from library */
-struct Record * read_title_get_record(struct Ordered_container *library_title)
+struct Record * read_title_get_record(struct Lexer *input, struct Ordered_container *library_title)
 {
-	return OC_safe_data_ptr(read_title_get_item_ptr(library_title));
+	return OC_safe_data_ptr(read_title_get_item_ptr(input, library_title));
 }
 
 /* Read record id and get record from library */
-struct Record * read_id_get_record(struct Ordered_container *library_id)
+struct Record * read_id_get_record(struct Lexer *input, struct Ordered_container *library_id)
 {
 	int id;
 	struct Record *record;
-	if (scanf("%d", &id) != 1)
+	if (!lex_int(input, &id))
 	{
-		integer_read_error();
+		integer_read_error(input);
 		return NULL;
 	}
 	record = OC_safe_data_ptr(OC_find_item_arg(library_id, &id, record_id_compare));
 	if (!record)
 	{
-		message_and_error("No record with that ID!\n");
+		message_and_error(input, "No record with that ID!\n");
 	}
 	return record;
 }
 
 /* Read in name and get item ptr to collection from library */
-void *read_name_get_item_ptr(struct Ordered_container *catalog)
+void *read_name_get_item_ptr(struct Lexer *input, struct Ordered_container *catalog)
 {
 	char name[NAME_BUFFER_SIZE];
 	void *item;
-	if (scanf(NAME_SCAN_BUFFER, name) != 1)
+	if (!lex_word(input, name, NAME_BUFFER_SIZE))
 	{
-		/* this should never happen because scanf will ignore all whitespace until the next character */
+		/* this should never happen because whitespace is skipped until the next character */
 		return NULL;
 	}
 	item = OC_find_item_arg(catalog, name, collection_name_compare);
 	if (!item)
 	{
-		message_and_error("No collection with that name!\n");
+		message_and_error(input, "No collection with that name!\n");
 	}
 	return item;
 }
 
 /* Read in name and get collection from library */
-struct Collection * read_name_get_collection(struct Ordered_container *catalog)
+struct Collection * read_name_get_collection(struct Lexer *input, struct Ordered_container *catalog)
 {
-	return OC_safe_data_ptr(read_name_get_item_ptr(catalog));
+	return OC_safe_data_ptr(read_name_get_item_ptr(input, catalog));
 }
 
 /* Return non-zero if there are no members, 0 if there are members */
@@ -656,12 +1440,6 @@ int Collection_not_empty(void* collection_ptr)
 	return !Collection_empty((const struct Collection *)collection_ptr);
 }
 
-/* Used to destroy all records in an Ordered container */
-void record_destroy(void * addr)
-{
-	destroy_Record((struct Record *)addr);
-}
-
 /* Used to destroy all collections in an Ordered container */
 void collection_destroy(void * addr)
 {
@@ -676,70 +1454,67 @@ void clear_catalog(struct Ordered_container *catalog)
 }
 
 /* Clear library */
-void clear_library(struct Ordered_container *library_title, struct Ordered_container *library_id)
+void clear_library(struct Library_data *data)
 {
-	OC_apply(library_title, record_destroy);
-	OC_clear(library_title);
-	OC_clear(library_id);
-	reset_Record_ID_counter();
+	clear_Library(data->library);
 }
 
 /* Clear all data */
-void clear_all(struct Ordered_container *catalog, struct Ordered_container *library_title, struct Ordered_container *library_id)
+void clear_all(struct Library_data *data)
 {
-	clear_catalog(catalog);
-	clear_library(library_title, library_id);
+	clear_catalog(data->catalog);
+	clear_library(data);
 }
 
 /* Clear all and print a message */
-void clear_all_message(struct Ordered_container *catalog, struct Ordered_container *library_title, struct Ordered_container *library_id)
+void clear_all_message(struct Library_data *data)
 {
-	clear_all(catalog, library_title, library_id);
-	printf("All data deleted\n");
+	clear_all(data);
+	output_string("All data deleted\n");
 }
 
 /* Reads in filename and open file with given mode */
-FILE * read_filename_open_file(char * mode)
+FILE * read_filename_open_file(struct Lexer *input, char * mode)
 {
 	char filename[FILE_BUFFER_SIZE];
 	FILE *file;
-	if (scanf(FILE_SCAN_BUFFER, filename) != 1)
+	if (!lex_word(input, filename, FILE_BUFFER_SIZE))
 	{
-		file_open_error();
+		file_open_error(input);
 		return NULL;
 	}
 	file = fopen(filename, mode);
 	if (!file)
 	{
-		file_open_error();
+		file_open_error(input);
 		return NULL;
 	}
 	return file;
 }
 
 /* Flushes the stream until the next \n */
-void flush_stream(void)
+void flush_stream(struct Lexer *input)
 {
-	while (getc(stdin) != '\n');
+	lex_skip_line(input);
 }
 
 /* Prints message and flushes */
-void message_and_error(char * message)
+void message_and_error(struct Lexer *input, char * message)
 {
-	printf(message);
-	flush_stream();
+	output_string(message);
+	flush_stream(input);
 }
 
 /* Prints message and flushes */
 void message_and_error_noflush(char * message)
 {
-	printf(message);
+	output_string(message);
 }
 
 /* Action Object input error message */
-void action_object_input_error(void)
+void action_object_input_error(struct Lexer *input)
 {
-	message_and_error("Unrecognized command!\n");
+	message_and_error(input, "Unrecognized command!\n");
 }
 
 /* Title read error message */
@@ -749,20 +1524,494 @@ void title_read_error(void)
 }
 
 /* Integer read error message */
-void integer_read_error(void)
+void integer_read_error(struct Lexer *input)
 {
-	message_and_error("Could not read an integer value!\n");
+	message_and_error(input, "Could not read an integer value!\n");
 }
 
 /* File open error message */
-void file_open_error(void)
+void file_open_error(struct Lexer *input)
 {
-	message_and_error("Could not open file!\n");
+	message_and_error(input, "Could not open file!\n");
 }
 
 /* File invalid error message and closes file */
-void file_invalid_error(FILE *file)
+void file_invalid_error(struct Lexer *input, FILE *file)
 {
-	message_and_error("Invalid data found in file!\n");
+	message_and_error(input, "Invalid data found in file!\n");
 	fclose(file);
-}
\ No newline at end of file
+}
+
+/* Reports the number of commands run in batch mode, the time taken, and the throughput */
+void report_batch_statistics(long command_count, clock_t start_time)
+{
+	double seconds = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+	fprintf(stderr, "Commands: %ld\n", command_count);
+	fprintf(stderr, "Elapsed time: %.3f seconds\n", seconds);
+	if (seconds > 0)
+	{
+		fprintf(stderr, "Throughput: %.0f commands per second\n", command_count / seconds);
+	}
+}
+
+/* Reads in text and prints the records whose titles match it in the given kind of search */
+void find_titles(struct Lexer *input, struct Title_index *title_index, int kind)
+{
+	char text_buffer[TITLE_BUFFER_SIZE];
+	char *text = read_title(text_buffer, input);
+	struct Record **found;
+	int count, i;
+	if (!text)
+	{
+		title_read_error();
+		return;
+	}
+	found = search_Title_index(title_index, text, kind, &count);
+	if (count > 0)
+	{
+		output_format("Found %d records:\n", count);
+		for (i = 0; i < count; i++)
+		{
+			print_Record(found[i]);
+		}
+	}
+	else
+	{
+		output_string("No records found\n");
+	}
+	free(found);
+}
+
+/* Reads in words and prints the records whose titles contain all or any of them,
+with those containing the most words first, and then those with the highest rating */
+void find_words(struct Lexer *input, struct Library_data *data, int require_all)
+{
+	char text_buffer[TITLE_BUFFER_SIZE];
+	char *text = read_title(text_buffer, input);
+	struct Word_match *matches;
+	struct Ranked_record *ranked;
+	int count, i;
+	if (!text)
+	{
+		title_read_error();
+		return;
+	}
+	matches = search_Word_index(data->word_index, text, require_all, &count);
+	if (count == 0)
+	{
+		output_string("No records found\n");
+		free(matches);
+		return;
+	}
+	ranked = malloc(count * sizeof(struct Ranked_record));
+	for (i = 0; i < count; i++)
+	{
+		ranked[i].record = OC_get_data_ptr(OC_find_item_arg(get_Library_by_ID(data->library), &matches[i].ID, record_id_compare));
+		ranked[i].words = matches[i].words;
+	}
+	qsort(ranked, count, sizeof(struct Ranked_record), ranked_record_compare);
+	output_format("Found %d records:\n", count);
+	for (i = 0; i < count; i++)
+	{
+		print_Record(ranked[i].record);
+	}
+	free(ranked);
+	free(matches);
+}
+
+/* Compare ranked records by the number of words, then rating, then id, for use with qsort */
+int ranked_record_compare(const void* first_ranked, const void* second_ranked)
+{
+	const struct Ranked_record *first = first_ranked;
+	const struct Ranked_record *second = second_ranked;
+	if (first->words != second->words)
+	{
+		return second->words - first->words;
+	}
+	if (get_Record_rating(first->record) != get_Record_rating(second->record))
+	{
+		return get_Record_rating(second->record) - get_Record_rating(first->record);
+	}
+	return get_Record_ID(first->record) - get_Record_ID(second->record);
+}
+
+/* Loads the given number of records from the file into the library all at once.
+Returns non-zero if invalid data was found. */
+int load_library(struct Lexer *file_input, int records, struct Library_data *data)
+{
+	struct Record **loaded;
+	int count;
+	if (records <= 0)
+	{
+		return 0;
+	}
+	loaded = malloc(records * sizeof(struct Record *));
+	if (!loaded)
+	{
+		return 1;
+	}
+	for (count = 0; count < records; count++)
+	{
+		struct Record *record = load_Record(file_input);
+		if (!record)
+		{
+			/* error loading a record */
+			break;
+		}
+		loaded[count] = record;
+	}
+	/* records are saved in title order, so each one goes at the end of the title ordering */
+	insert_Library_records(data->library, loaded, count);
+	free(loaded);
+	return count < records;
+}
+
+/* Saves all of the data to a file in the current save file format; the file must be open for
+reading as well, as the checksums are computed from what was written */
+void save_all(FILE *outfile, struct Ordered_container *catalog, struct Ordered_container *library_title)
+{
+	struct Save_section sections[SAVE_SECTIONS];
+	long table_offset;
+	memset(sections, 0, sizeof(sections));
+	fprintf(outfile, "%s %d\n", SAVE_FORMAT_HEADER, SAVE_FORMAT_VERSION);
+	/* the table is written again once the sections are, so that it can come first */
+	table_offset = ftell(outfile);
+	write_section_table(outfile, sections);
+	sections[0].count = OC_get_size(library_title);
+	sections[0].offset = ftell(outfile);
+	fprintf(outfile, "%d\n", sections[0].count);
+	OC_apply_arg(library_title, record_save, outfile);
+	sections[1].count = OC_get_size(catalog);
+	sections[1].offset = ftell(outfile);
+	fprintf(outfile, "%d\n", sections[1].count);
+	OC_apply_arg(catalog, collection_save, outfile);
+	sections[0].size = sections[1].offset - sections[0].offset;
+	sections[1].size = ftell(outfile) - sections[1].offset;
+	checksum_sections(outfile, sections);
+	fseek(outfile, table_offset, SEEK_SET);
+	write_section_table(outfile, sections);
+	fseek(outfile, 0L, SEEK_END);
+}
+
+/* Writes the table of sections of a save file, whose entries are always the same length */
+void write_section_table(FILE *outfile, const struct Save_section *sections)
+{
+	int i;
+	for (i = 0; i < SAVE_SECTIONS; i++)
+	{
+		fprintf(outfile, SAVE_SECTION_FORMAT, save_section_names[i], sections[i].count,
+			sections[i].offset, sections[i].size, sections[i].checksum);
+	}
+}
+
+/* Computes the checksums of the sections from the bytes in the file.
+Returns non-zero if they could not all be read. */
+int checksum_sections(FILE *file, struct Save_section *sections)
+{
+	char buffer[CHECKSUM_BUFFER_SIZE];
+	int i;
+	for (i = 0; i < SAVE_SECTIONS; i++)
+	{
+		long remaining = sections[i].size;
+		sections[i].checksum = CHECKSUM_INITIAL;
+		if (fseek(file, sections[i].offset, SEEK_SET) != 0)
+		{
+			return 1;
+		}
+		while (remaining > 0)
+		{
+			size_t bytes = fread(buffer, 1, remaining < CHECKSUM_BUFFER_SIZE ? remaining : CHECKSUM_BUFFER_SIZE, file);
+			if (bytes == 0)
+			{
+				return 1;
+			}
+			sections[i].checksum = update_checksum(sections[i].checksum, buffer, bytes);
+			remaining -= bytes;
+		}
+	}
+	return 0;
+}
+
+/* Checks the sections of a save file against the checksums in its table, reading the file
+once without changing any data. Returns non-zero if the file is invalid; files of versions
+without the table are not checked. */
+int check_save_file(FILE *infile)
+{
+	struct Save_section sections[SAVE_SECTIONS], computed[SAVE_SECTIONS];
+	char word[NAME_BUFFER_SIZE];
+	int version, i;
+	if (fscanf(infile, NAME_SCAN_BUFFER " %d", word, &version) != 2 || strcmp(word, SAVE_FORMAT_HEADER) != 0
+		|| version < SAVE_FORMAT_SECTIONS_VERSION)
+	{
+		return 0;
+	}
+	for (i = 0; i < SAVE_SECTIONS; i++)
+	{
+		if (fscanf(infile, NAME_SCAN_BUFFER " %d %ld %ld %lx", word, &sections[i].count, &sections[i].offset,
+				&sections[i].size, &sections[i].checksum) != 5 || strcmp(word, save_section_names[i]) != 0
+			|| sections[i].count < 0 || sections[i].size < 0
+			|| (i > 0 && sections[i].offset != sections[i - 1].offset + sections[i - 1].size))
+		{
+			return 1;
+		}
+	}
+	/* the sections follow one another from the line after the table to the end of the file */
+	if (sections[0].offset != ftell(infile) + 1 || fseek(infile, 0L, SEEK_END) != 0
+		|| ftell(infile) != sections[SAVE_SECTIONS - 1].offset + sections[SAVE_SECTIONS - 1].size)
+	{
+		return 1;
+	}
+	memcpy(computed, sections, sizeof(sections));
+	if (checksum_sections(infile, computed))
+	{
+		return 1;
+	}
+	for (i = 0; i < SAVE_SECTIONS; i++)
+	{
+		if (computed[i].checksum != sections[i].checksum)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Reads the table of sections of a save file, keeping the number of records or collections
+in each section. Returns non-zero if invalid data was found. */
+int load_section_counts(struct Lexer *file_input, int *counts)
+{
+	char word[NAME_BUFFER_SIZE];
+	int i;
+	for (i = 0; i < SAVE_SECTIONS; i++)
+	{
+		/* the offset, size, and checksum are only needed by check_save_file */
+		if (!lex_word(file_input, word, NAME_BUFFER_SIZE) || strcmp(word, save_section_names[i]) != 0
+			|| !lex_int(file_input, &counts[i]) || !lex_word(file_input, word, NAME_BUFFER_SIZE)
+			|| !lex_word(file_input, word, NAME_BUFFER_SIZE) || !lex_word(file_input, word, NAME_BUFFER_SIZE))
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Loads all of the data in a save file of any format into the empty library and catalog.
+Returns non-zero if invalid data was found. */
+int load_all(struct Lexer *file_input, struct Library_data *data)
+{
+	int version = 1;
+	int records, collections;
+	int counts[SAVE_SECTIONS];
+	int next = lex_peek_char(file_input);
+	if (next != EOF && !isdigit(next) && next != '-' && next != '+')
+	{
+		/* version 1 files start with the number of records, later versions with a header */
+		char header[NAME_BUFFER_SIZE];
+		if (!lex_word(file_input, header, NAME_BUFFER_SIZE) || strcmp(header, SAVE_FORMAT_HEADER) != 0
+			|| !lex_int(file_input, &version) || version < 2 || version > SAVE_FORMAT_VERSION)
+		{
+			return 1;
+		}
+	}
+	if (version >= SAVE_FORMAT_SECTIONS_VERSION && load_section_counts(file_input, counts))
+	{
+		return 1;
+	}
+	if (!lex_int(file_input, &records) || (version >= SAVE_FORMAT_SECTIONS_VERSION && records != counts[0])
+		|| load_library(file_input, records, data))
+	{
+		return 1;
+	}
+	if (!lex_int(file_input, &collections) || (version >= SAVE_FORMAT_SECTIONS_VERSION && collections != counts[1]))
+	{
+		return 1;
+	}
+	lex_skip_whitespace(file_input);
+	for (; collections > 0; collections--)
+	{
+		struct Collection *collection = (version == 1) ? load_Collection(file_input, get_Library_by_title(data->library))
+			: load_Collection_by_ID(file_input, get_Library_by_ID(data->library));
+		if (!collection)
+		{
+			/* error loading a collection */
+			return 1;
+		}
+		OC_insert(data->catalog, collection);
+	}
+	return 0;
+}
+
+/* Applies the entries of a journal file to the data, writing them to the active journal as well.
+Returns non-zero if an invalid entry was found; the entries before it remain applied. */
+int replay_journal(struct Lexer *file_input, struct Library_data *data)
+{
+	char action, object;
+	while (lex_char(file_input, &action))
+	{
+		/* a single character at the end is a partly written entry */
+		if (!lex_char(file_input, &object) || replay_journal_entry(file_input, action, object, data))
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* Discards the journal entries once the data has been saved or restored, reporting a failure */
+void checkpoint_journal(struct Journal *journal)
+{
+	if (checkpoint_Journal(journal))
+	{
+		message_and_error_noflush("Could not empty the journal file!\n");
+	}
+}
+
+/* Applies a single journal entry for the given command; returns non-zero if the entry is invalid */
+int replay_journal_entry(struct Lexer *file_input, char action, char object, struct Library_data *data)
+{
+	char name[NAME_BUFFER_SIZE];
+	int id, rating;
+	struct Record *record;
+	struct Collection *collection;
+	if (action == 'a' && object == 'r')
+	{
+		record = load_Record(file_input);
+		if (!record)
+		{
+			return 1;
+		}
+		if (OC_find_item(get_Library_by_title(data->library), record))
+		{
+			destroy_Record(record);
+			return 1;
+		}
+		insert_Library_record(data->library, record);
+		journal_record_entry(data->journal, record);
+		return 0;
+	}
+	if (action == 'c')
+	{
+		switch (object)
+		{
+			case 'L':
+				if (OC_apply_if(data->catalog, Collection_not_empty))
+				{
+					return 1;
+				}
+				clear_library(data);
+				break;
+			case 'C':
+				clear_catalog(data->catalog);
+				break;
+			case 'A':
+				clear_all(data);
+				break;
+			default:
+				return 1;
+		}
+		journal_entry(data->journal, "c%c\n", object);
+		return 0;
+	}
+	if (action == 'd' && (object == 'K' || object == 'M'))
+	{
+		char medium[MEDIUM_BUFFER_SIZE];
+		struct Bulk_delete bulk;
+		if (object == 'K')
+		{
+			if (!lex_int(file_input, &bulk.rating) || bulk.rating < RATING_MIN || bulk.rating > RATING_MAX)
+			{
+				return 1;
+			}
+			bulk.medium = NULL;
+			bulk_delete(data, &bulk);
+			journal_entry(data->journal, "dK %d\n", bulk.rating);
+		}
+		else
+		{
+			if (!lex_word(file_input, medium, MEDIUM_BUFFER_SIZE))
+			{
+				return 1;
+			}
+			bulk.medium = medium;
+			bulk_delete(data, &bulk);
+			journal_entry(data->journal, "dM %s\n", medium);
+		}
+		return 0;
+	}
+	/* every other entry starts with a record ID or a collection name */
+	if (action == 'm' || (action == 'd' && object == 'r'))
+	{
+		if (!lex_int(file_input, &id))
+		{
+			return 1;
+		}
+		record = OC_safe_data_ptr(OC_find_item_arg(get_Library_by_ID(data->library), &id, record_id_compare));
+		if (!record)
+		{
+			return 1;
+		}
+		if (action == 'm' && object == 'r')
+		{
+			if (!lex_int(file_input, &rating) || rating < RATING_MIN || rating > RATING_MAX)
+			{
+				return 1;
+			}
+			modify_Library_record_rating(data->library, record, rating);
+			journal_entry(data->journal, "mr %d %d\n", id, rating);
+			return 0;
+		}
+		if (action == 'd' && !is_collection_member(record))
+		{
+			erase_Library_record(data->library, OC_find_item(get_Library_by_title(data->library), record));
+			journal_entry(data->journal, "dr %d\n", id);
+			return 0;
+		}
+		return 1;
+	}
+	if (!lex_word(file_input, name, NAME_BUFFER_SIZE))
+	{
+		return 1;
+	}
+	if (action == 'a' && object == 'c')
+	{
+		if (OC_find_item_arg(data->catalog, name, collection_name_compare))
+		{
+			return 1;
+		}
+		OC_insert(data->catalog, create_Collection(name));
+		journal_entry(data->journal, "ac %s\n", name);
+		return 0;
+	}
+	collection = OC_safe_data_ptr(OC_find_item_arg(data->catalog, name, collection_name_compare));
+	if (!collection)
+	{
+		return 1;
+	}
+	if (action == 'd' && object == 'c')
+	{
+		OC_delete_item(data->catalog, OC_find_item(data->catalog, collection));
+		journal_entry(data->journal, "dc %s\n", name);
+		destroy_Collection(collection);
+		return 0;
+	}
+	if (!lex_int(file_input, &id))
+	{
+		return 1;
+	}
+	record = OC_safe_data_ptr(OC_find_item_arg(get_Library_by_ID(data->library), &id, record_id_compare));
+	if (!record)
+	{
+		return 1;
+	}
+	if (action == 'a' && object == 'm' && !add_Collection_member(collection, record))
+	{
+		journal_entry(data->journal, "am %s %d\n", name, id);
+		return 0;
+	}
+	if (action == 'd' && object == 'm' && !remove_Collection_member(collection, record))
+	{
+		journal_entry(data->journal, "dm %s %d\n", name, id);
+		return 0;
+	}
+	return 1;
+}